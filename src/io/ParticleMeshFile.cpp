@@ -0,0 +1,419 @@
+//  Copyright by Christoph Saffer, Paul Rudolph, Sandra Timme, Marco Blickensdorf, Johannes Pollmächer
+//  Research Group Applied Systems Biology - Head: Prof. Dr. Marc Thilo Figge
+//  https://www.leibniz-hki.de/en/applied-systems-biology.html
+//  HKI-Center for Systems Biology of Infection
+//  Leibniz Institute for Natural Product Research and Infection Biology - Hans Knöll Insitute (HKI)
+//  Adolf-Reichwein-Straße 23, 07745 Jena, Germany
+//
+//  This code is licensed under BSD 2-Clause
+//  See the LICENSE file provided with this code for the full license.
+
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#include <boost/filesystem.hpp>
+
+#include "io/ParticleMeshFile.h"
+#include "utils/macros.h"
+
+namespace {
+    constexpr char meshFileMagic[8] = {'A', 'B', 'M', 'M', 'S', 'H', '2', '\0'};
+    constexpr size_t meshHeaderSize = sizeof(meshFileMagic) + 3 * sizeof(std::uint64_t);
+
+    size_t meshFileSize(std::uint64_t particles, std::uint64_t neighbours) {
+        return meshHeaderSize + (5 * particles + neighbours) * sizeof(double) +
+               (particles + 1 + neighbours) * sizeof(std::uint32_t);
+    }
+
+    template<typename T>
+    void writeArray(std::ofstream &out, const std::vector<T> &values) {
+        out.write(reinterpret_cast<const char *>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+    }
+
+    // SAX-style reader of the particle-delauney XML format, the mesh is built tag by tag while the file is read in chunks
+    // (Agent-Based-Framework/Particles/Particle with the DataFields id, position, concentration and area and the
+    // Interactions/Particle neighbours with the DataFields id and contact), everything else is skipped
+    class StreamingMeshReader {
+    public:
+        /*!
+         * Processes all complete tags of a chunk
+         * @param data pointer to the chunk, attribute values are terminated in place
+         * @param size size of the chunk
+         * @param last Boolean that is true if the chunk ends with the file
+         * @return size_t that contains the number of processed characters, where an incomplete tag starts
+         */
+        size_t parse(char *data, size_t size, bool last) {
+            size_t position = 0;
+            while (position < size) {
+                char *begin = static_cast<char *>(std::memchr(data + position, '<', size - position));
+                if (begin == nullptr) {
+                    return size; // text between tags
+                }
+                const auto start = static_cast<size_t>(begin - data);
+                size_t end;
+                if (size - start >= 4 && std::strncmp(begin, "<!--", 4) == 0) {
+                    end = findEnd(data, start + 4, size, "-->");
+                } else {
+                    end = findTagEnd(data, start, size);
+                }
+                if (end == size) {
+                    if (last) {
+                        ERROR_STDERR("Particle mesh ends inside of a tag");
+                        exit(1);
+                    }
+                    return start;
+                }
+                if (begin[1] != '!' && begin[1] != '?') {
+                    processTag(begin + 1, data + end);
+                }
+                position = end + 1;
+            }
+            return size;
+        }
+
+        ParticleMesh finish() {
+            // neighbours may be listed before their particle, the ids of the file are replaced at the end
+            std::stable_sort(particleIndices.begin(), particleIndices.end(),
+                             [](const auto &a, const auto &b) { return a.first < b.first; });
+            mesh.neighbourIds.reserve(neighbourFileIds.size());
+            for (const auto fileId: neighbourFileIds) {
+                auto match = std::upper_bound(particleIndices.begin(), particleIndices.end(), fileId,
+                                              [](unsigned int id, const auto &entry) { return id < entry.first; });
+                // the last particle with an id wins, an unknown id refers to the first particle (like a std::map lookup)
+                const bool known = match != particleIndices.begin() && (match - 1)->first == fileId;
+                mesh.neighbourIds.push_back(known ? (match - 1)->second : 0);
+            }
+            neighbourFileIds = std::vector<unsigned int>();
+            particleIndices = std::vector<std::pair<unsigned int, std::uint32_t>>();
+            if (mesh.neighbourOffsets.empty()) {
+                mesh.neighbourOffsets.push_back(0);
+            }
+            return std::move(mesh);
+        }
+
+    private:
+        enum class Element {
+            OTHER,
+            PARTICLES,
+            PARTICLE,
+            INTERACTIONS,
+            NEIGHBOUR,
+            DATAFIELD
+        };
+        enum class Field {
+            OTHER,
+            ID,
+            POSITION,
+            CONCENTRATION,
+            AREA,
+            CONTACT
+        };
+
+        static size_t findEnd(const char *data, size_t position, size_t size, const char *pattern) {
+            const auto length = std::strlen(pattern);
+            for (; position + length <= size; position++) {
+                if (std::strncmp(data + position, pattern, length) == 0) {
+                    return position + length - 1;
+                }
+            }
+            return size;
+        }
+
+        // the closing '>' of a tag, a '>' inside of an attribute value does not end it
+        static size_t findTagEnd(const char *data, size_t position, size_t size) {
+            char quote = 0;
+            for (; position < size; position++) {
+                if (quote != 0) {
+                    quote = data[position] == quote ? 0 : quote;
+                } else if (data[position] == '"' || data[position] == '\'') {
+                    quote = data[position];
+                } else if (data[position] == '>') {
+                    return position;
+                }
+            }
+            return size;
+        }
+
+        static bool isName(const char *begin, const char *end, const char *name) {
+            const auto length = std::strlen(name);
+            return static_cast<size_t>(end - begin) == length && std::strncmp(begin, name, length) == 0;
+        }
+
+        // tag content between '<' and '>'
+        void processTag(char *begin, char *end) {
+            if (*begin == '/') {
+                closeElement();
+                return;
+            }
+            const bool selfClosing = end[-1] == '/';
+            if (selfClosing) {
+                end--;
+            }
+            char *nameEnd = begin;
+            while (nameEnd < end && !std::isspace(static_cast<unsigned char>(*nameEnd))) {
+                nameEnd++;
+            }
+            openElement(begin, nameEnd, nameEnd, end);
+            if (selfClosing) {
+                closeElement();
+            }
+        }
+
+        // calls function(name begin, name end, value) for every attribute, values are terminated in place
+        template<typename Function>
+        static void forAttributes(char *position, char *end, Function function) {
+            while (position < end) {
+                while (position < end && std::isspace(static_cast<unsigned char>(*position))) {
+                    position++;
+                }
+                char *nameBegin = position;
+                while (position < end && *position != '=' && !std::isspace(static_cast<unsigned char>(*position))) {
+                    position++;
+                }
+                char *nameEnd = position;
+                while (position < end && *position != '"' && *position != '\'') {
+                    position++;
+                }
+                if (position >= end) {
+                    return;
+                }
+                const char quote = *position++;
+                char *value = position;
+                while (position < end && *position != quote) {
+                    position++;
+                }
+                if (position >= end) {
+                    return;
+                }
+                *position++ = '\0';
+                function(nameBegin, nameEnd, value);
+            }
+        }
+
+        void openElement(char *nameBegin, char *nameEnd, char *attributes, char *end) {
+            const auto parent = stack.empty() ? Element::OTHER : stack.back();
+            auto element = Element::OTHER;
+            if (isName(nameBegin, nameEnd, "Particles") && stack.size() == 1) {
+                element = Element::PARTICLES;
+            } else if (isName(nameBegin, nameEnd, "Particle") && parent == Element::PARTICLES) {
+                element = Element::PARTICLE;
+                particle = ParticleValues();
+            } else if (isName(nameBegin, nameEnd, "Interactions") && parent == Element::PARTICLE) {
+                element = Element::INTERACTIONS;
+            } else if (isName(nameBegin, nameEnd, "Particle") && parent == Element::INTERACTIONS) {
+                element = Element::NEIGHBOUR;
+                neighbour = NeighbourValues();
+            } else if (isName(nameBegin, nameEnd, "DataField") &&
+                       (parent == Element::PARTICLE || parent == Element::NEIGHBOUR)) {
+                element = Element::DATAFIELD;
+                field = Field::OTHER;
+                valueRead = false;
+                forAttributes(attributes, end, [&](const char *attributeBegin, const char *attributeEnd, const char *value) {
+                    if (isName(attributeBegin, attributeEnd, "name")) {
+                        field = fieldFromName(value, parent == Element::NEIGHBOUR);
+                    }
+                });
+            } else if (parent == Element::DATAFIELD && field != Field::OTHER) {
+                readValue(nameBegin, nameEnd, attributes, end);
+            }
+            stack.push_back(element);
+        }
+
+        // the first DataField of a name and its first Value are used, like InputConfiguration::get*DataFieldValueByName
+        Field fieldFromName(const char *name, bool ofNeighbour) {
+            auto &seen = ofNeighbour ? neighbour.seen : particle.seen;
+            Field result = Field::OTHER;
+            if (std::strcmp(name, "id") == 0) {
+                result = Field::ID;
+            } else if (!ofNeighbour && std::strcmp(name, "position") == 0) {
+                result = Field::POSITION;
+            } else if (!ofNeighbour && std::strcmp(name, "concentration") == 0) {
+                result = Field::CONCENTRATION;
+            } else if (!ofNeighbour && std::strcmp(name, "area") == 0) {
+                result = Field::AREA;
+            } else if (ofNeighbour && std::strcmp(name, "contact") == 0) {
+                result = Field::CONTACT;
+            }
+            const auto bit = 1u << static_cast<unsigned int>(result);
+            if (result == Field::OTHER || (seen & bit) != 0) {
+                return Field::OTHER;
+            }
+            seen |= bit;
+            return result;
+        }
+
+        void readValue(const char *nameBegin, const char *nameEnd, char *attributes, char *end) {
+            const bool values = isName(nameBegin, nameEnd, "Values");
+            if (!values && !isName(nameBegin, nameEnd, "Value")) {
+                return;
+            }
+            // a position is given by its Values, its first Value is only used if there are none
+            if (field == Field::POSITION ? (valueRead && !values) || positionFromValues : valueRead || values) {
+                return;
+            }
+            valueRead = true;
+            positionFromValues = field == Field::POSITION && values;
+            forAttributes(attributes, end, [&](const char *attributeBegin, const char *attributeEnd, const char *value) {
+                if (field == Field::POSITION) {
+                    for (unsigned int axis = 0; axis < 3; axis++) {
+                        const char axisNames[3][7] = {"xValue", "yValue", "zValue"};
+                        if (isName(attributeBegin, attributeEnd, axisNames[axis])) {
+                            particle.position[axis] = std::atof(value);
+                        }
+                    }
+                } else if (isName(attributeBegin, attributeEnd, "value")) {
+                    switch (field) {
+                        case Field::ID:
+                            (stack.size() > 1 && stack[stack.size() - 2] == Element::NEIGHBOUR ? neighbour.id : particle.id) =
+                                    static_cast<unsigned int>(std::atoi(value));
+                            break;
+                        case Field::CONCENTRATION:
+                            particle.concentration = std::atof(value);
+                            break;
+                        case Field::AREA:
+                            particle.area = std::atof(value);
+                            break;
+                        case Field::CONTACT:
+                            neighbour.contact = std::atof(value);
+                            break;
+                        default:
+                            break;
+                    }
+                }
+            });
+        }
+
+        void closeElement() {
+            if (stack.empty()) {
+                return;
+            }
+            const auto element = stack.back();
+            stack.pop_back();
+            if (element == Element::DATAFIELD) {
+                field = Field::OTHER;
+                positionFromValues = false;
+            } else if (element == Element::NEIGHBOUR) {
+                neighbourFileIds.push_back(neighbour.id);
+                mesh.contactAreas.push_back(neighbour.contact);
+            } else if (element == Element::PARTICLE) {
+                if (mesh.neighbourOffsets.empty()) {
+                    mesh.neighbourOffsets.push_back(0);
+                }
+                particleIndices.emplace_back(particle.id, static_cast<std::uint32_t>(mesh.areas.size()));
+                mesh.positions.insert(mesh.positions.end(), particle.position.begin(), particle.position.end());
+                mesh.areas.push_back(particle.area);
+                mesh.concentrations.push_back(particle.concentration);
+                mesh.neighbourOffsets.push_back(static_cast<std::uint32_t>(neighbourFileIds.size()));
+            }
+        }
+
+        struct ParticleValues {
+            unsigned int id = 0;
+            std::array<double, 3> position{};
+            double concentration = 0;
+            double area = 0;
+            unsigned int seen = 0;
+        };
+        struct NeighbourValues {
+            unsigned int id = 0;
+            double contact = 0;
+            unsigned int seen = 0;
+        };
+
+        ParticleMesh mesh;
+        std::vector<unsigned int> neighbourFileIds;
+        std::vector<std::pair<unsigned int, std::uint32_t>> particleIndices; // id in the file and index of each particle
+        std::vector<Element> stack;
+        ParticleValues particle;
+        NeighbourValues neighbour;
+        Field field = Field::OTHER;
+        bool valueRead = false;
+        bool positionFromValues = false;
+    };
+}
+
+ParticleMesh ParticleMeshFile::readXML(const std::string &xmlFile) {
+    std::ifstream in(xmlFile, std::ios::binary);
+    if (!in) {
+        ERROR_STDERR("Could not open particle mesh " << xmlFile);
+        exit(1);
+    }
+    StreamingMeshReader reader;
+    // a tag that is cut by the end of the chunk is moved to the front and completed by the next chunk
+    std::vector<char> buffer(1 << 20);
+    size_t filled = 0;
+    while (in) {
+        if (filled == buffer.size()) {
+            buffer.resize(2 * buffer.size()); // a single tag longer than the buffer
+        }
+        in.read(buffer.data() + filled, static_cast<std::streamsize>(buffer.size() - filled));
+        filled += static_cast<size_t>(in.gcount());
+        const auto consumed = reader.parse(buffer.data(), filled, !in);
+        std::memmove(buffer.data(), buffer.data() + consumed, filled - consumed);
+        filled -= consumed;
+    }
+    auto mesh = reader.finish();
+    mesh.sourceSize = boost::filesystem::file_size(xmlFile);
+    return mesh;
+}
+
+bool ParticleMeshFile::write(const std::string &file, const ParticleMesh &mesh) {
+    const auto target = boost::filesystem::path(file);
+    const auto tmpFile = target.parent_path() / boost::filesystem::unique_path(target.filename().string() + "-%%%%-%%%%.tmp");
+    boost::system::error_code error;
+    {
+        std::ofstream out(tmpFile.string(), std::ios::binary);
+        const std::uint64_t header[3] = {mesh.areas.size(), mesh.neighbourIds.size(), mesh.sourceSize};
+        out.write(meshFileMagic, sizeof(meshFileMagic));
+        out.write(reinterpret_cast<const char *>(header), sizeof(header));
+        // all doubles first, so every array is aligned to its element size
+        writeArray(out, mesh.positions);
+        writeArray(out, mesh.areas);
+        writeArray(out, mesh.concentrations);
+        writeArray(out, mesh.contactAreas);
+        writeArray(out, mesh.neighbourOffsets);
+        writeArray(out, mesh.neighbourIds);
+        if (!out) {
+            boost::filesystem::remove(tmpFile, error);
+            return false;
+        }
+    }
+    boost::filesystem::rename(tmpFile, target, error);
+    return !error;
+}
+
+std::string ParticleMeshFile::cachePath(const std::string &xmlFile) {
+    return boost::filesystem::path(xmlFile).replace_extension(".mesh").string();
+}
+
+bool ParticleMeshFile::open(const std::string &file) {
+    if (!boost::filesystem::exists(file) || boost::filesystem::file_size(file) < meshHeaderSize) {
+        return false;
+    }
+    mapping = boost::interprocess::file_mapping(file.c_str(), boost::interprocess::read_only);
+    region = boost::interprocess::mapped_region(mapping, boost::interprocess::read_only);
+    const auto *data = static_cast<const char *>(region.get_address());
+    std::uint64_t header[3];
+    std::memcpy(header, data + sizeof(meshFileMagic), sizeof(header));
+    if (std::memcmp(data, meshFileMagic, sizeof(meshFileMagic)) != 0 ||
+        region.get_size() != meshFileSize(header[0], header[1])) {
+        region = boost::interprocess::mapped_region();
+        return false;
+    }
+
+    numberOfParticles = header[0];
+    sourceSize = header[2];
+    positions = reinterpret_cast<const double *>(data + meshHeaderSize);
+    areas = positions + 3 * numberOfParticles;
+    concentrations = areas + numberOfParticles;
+    contactAreas = concentrations + numberOfParticles;
+    neighbourOffsets = reinterpret_cast<const std::uint32_t *>(contactAreas + header[1]);
+    neighbourIds = neighbourOffsets + numberOfParticles + 1;
+    return true;
+}
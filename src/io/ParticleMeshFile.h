@@ -0,0 +1,88 @@
+//  Copyright by Christoph Saffer, Paul Rudolph, Sandra Timme, Marco Blickensdorf, Johannes Pollmächer
+//  Research Group Applied Systems Biology - Head: Prof. Dr. Marc Thilo Figge
+//  https://www.leibniz-hki.de/en/applied-systems-biology.html
+//  HKI-Center for Systems Biology of Infection
+//  Leibniz Institute for Natural Product Research and Infection Biology - Hans Knöll Insitute (HKI)
+//  Adolf-Reichwein-Straße 23, 07745 Jena, Germany
+//
+//  This code is licensed under BSD 2-Clause
+//  See the LICENSE file provided with this code for the full license.
+
+
+#ifndef PARTICLEMESHFILE_H
+#define PARTICLEMESHFILE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+/// Particle mesh (the content of a particle-delauney input) with the neighbours in compressed sparse row format
+struct ParticleMesh {
+    std::vector<double> positions; // x, y and z of each particle
+    std::vector<double> areas;
+    std::vector<double> concentrations;
+    std::vector<std::uint32_t> neighbourOffsets; // neighbours of particle i are stored in [offsets[i], offsets[i + 1])
+    std::vector<std::uint32_t> neighbourIds;
+    std::vector<double> contactAreas;
+    std::uint64_t sourceSize = 0; // size of the XML input in bytes (0 if the mesh was not read from a file)
+};
+
+class ParticleMeshFile {
+public:
+    /// Class for a binary particle mesh file, that is memory-mapped and read without any parsing
+    /// File layout: magic, number of particles, number of neighbours and size of the XML input (uint64 each), positions,
+    /// areas, concentrations, contact areas (double each), neighbour offsets and neighbour ids (uint32 each)
+    ParticleMeshFile() = default;
+
+    /*!
+     * Reads a particle-delauney XML input, the ids of the particles are replaced by their position in the file
+     * @param xmlFile String that contains the path of the XML file
+     * @return ParticleMesh object that contains the mesh
+     */
+    static ParticleMesh readXML(const std::string &xmlFile);
+
+    /*!
+     * Writes a mesh in the binary format, the file is replaced atomically, parallel runs never see a partial file
+     * @param file String that contains the path of the binary file
+     * @param mesh ParticleMesh object
+     * @return Boolean that is false if the file could not be written (read-only input directory)
+     */
+    static bool write(const std::string &file, const ParticleMesh &mesh);
+
+    /// Returns the path of the binary cache that belongs to a particle-delauney XML input
+    static std::string cachePath(const std::string &xmlFile);
+
+    /*!
+     * Maps a binary mesh file
+     * @param file String that contains the path of the binary file
+     * @return Boolean that is false if the file does not exist or is no valid mesh file
+     */
+    bool open(const std::string &file);
+
+    [[nodiscard]] size_t getNumberOfParticles() const { return numberOfParticles; }
+    /// Returns the size of the XML input that the mesh was converted from, used to detect a changed input
+    [[nodiscard]] std::uint64_t getSourceSize() const { return sourceSize; }
+    [[nodiscard]] const double *getPositions() const { return positions; }
+    [[nodiscard]] const double *getAreas() const { return areas; }
+    [[nodiscard]] const double *getConcentrations() const { return concentrations; }
+    [[nodiscard]] const std::uint32_t *getNeighbourOffsets() const { return neighbourOffsets; }
+    [[nodiscard]] const std::uint32_t *getNeighbourIds() const { return neighbourIds; }
+    [[nodiscard]] const double *getContactAreas() const { return contactAreas; }
+
+private:
+    boost::interprocess::file_mapping mapping;
+    boost::interprocess::mapped_region region;
+    size_t numberOfParticles = 0;
+    std::uint64_t sourceSize = 0;
+    const double *positions = nullptr;
+    const double *areas = nullptr;
+    const double *concentrations = nullptr;
+    const double *contactAreas = nullptr;
+    const std::uint32_t *neighbourOffsets = nullptr;
+    const std::uint32_t *neighbourIds = nullptr;
+};
+
+#endif    /* PARTICLEMESHFILE_H */
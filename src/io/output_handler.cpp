@@ -141,7 +141,7 @@ void OutputHandler::outputCurrentConfiguration(const Site &site,
                                                std::unordered_map<std::string, std::string> cmd_input_args) const {
 
     bool writeout = (0 == time % static_cast<int>(parameters_.output_interval));
-    if (site.getParticleManager()->getDiffusionCoefficient() > 500) {
+    if (site.getParticleManager()->allowsSteadyState()) {
         // In ParticleManager::steadyStateReached - timestep changes during the simulation when a steady state is reached
         // Output interval must be adjusted to generate homogeneous output
         int frames_per_minute = parameters_.output_interval;
@@ -0,0 +1,38 @@
+//  Copyright by Christoph Saffer, Paul Rudolph, Sandra Timme, Marco Blickensdorf, Johannes Pollmächer
+//  Research Group Applied Systems Biology - Head: Prof. Dr. Marc Thilo Figge
+//  https://www.leibniz-hki.de/en/applied-systems-biology.html
+//  HKI-Center for Systems Biology of Infection
+//  Leibniz Institute for Natural Product Research and Infection Biology - Hans Knöll Insitute (HKI)
+//  Adolf-Reichwein-Straße 23, 07745 Jena, Germany
+//
+//  This code is licensed under BSD 2-Clause
+//  See the LICENSE file provided with this code for the full license.
+
+
+#include <boost/filesystem.hpp>
+
+#include "io/ParticleMeshFile.h"
+#include "utils/macros.h"
+
+// Converts a particle-delauney XML input into the binary mesh format that is memory-mapped by the simulation
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        ERROR_STDERR("usage: " << argv[0] << " <particle-delauney.xml> [<output.mesh>]");
+        return 1;
+    }
+    const std::string xmlFile = argv[1];
+    if (!boost::filesystem::exists(xmlFile)) {
+        ERROR_STDERR("Particle mesh " << xmlFile << " does not exist!");
+        return 2;
+    }
+    const std::string meshFile = argc == 3 ? argv[2] : ParticleMeshFile::cachePath(xmlFile);
+
+    const auto mesh = ParticleMeshFile::readXML(xmlFile);
+    if (!ParticleMeshFile::write(meshFile, mesh)) {
+        ERROR_STDERR("Could not write " << meshFile);
+        return 3;
+    }
+    SYSTEM_STDOUT("Wrote " << mesh.areas.size() << " particles with " << mesh.neighbourIds.size() << " neighbours to "
+                           << meshFile);
+    return 0;
+}
@@ -12,6 +12,8 @@
 #define    _AGENT_H
 
 #include <iostream>
+#include <utility>
+#include <vector>
 
 #include "basic/Coordinate3D.h"
 #include "simulation/movement/RandomWalk.h"
@@ -62,6 +64,9 @@ public:
     Coordinate3D getCurrentPosition() { return *position; };
     Coordinate3D getCoordinateWithinAgent(Agent *);
     std::map<std::string, double> molecule_uptake;
+    // uptake of the current timestep as (particle id, concentration change), the site adds it to the field after the
+    // agent phase
+    std::vector<std::pair<unsigned int, double>> particle_uptake;
 
     virtual void doAllActionsForTimestep(double timestep, double current_time) = 0;
     virtual void move(double timestep, double current_time) = 0;
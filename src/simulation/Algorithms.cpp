@@ -149,75 +149,39 @@ Algorithms::interpolateBilinearOnTriangle(Coordinate3D pointOfInterest, Coordina
     return wP;
 }
 
+std::array<double, 3> Algorithms::barycentricCoordinates(const Coordinate3D &pointOfInterest, const Coordinate3D &c1,
+                                                         const Coordinate3D &c2, const Coordinate3D &c3) {
+    const Coordinate3D v1 = c2 - c1;
+    const Coordinate3D v2 = c3 - c1;
+    const Coordinate3D vp = pointOfInterest - c1;
+    const double d11 = v1.scalarProduct(v1);
+    const double d12 = v1.scalarProduct(v2);
+    const double d22 = v2.scalarProduct(v2);
+    const double dp1 = vp.scalarProduct(v1);
+    const double dp2 = vp.scalarProduct(v2);
+    const double denominator = d11 * d22 - d12 * d12;
+    const double l2 = (d22 * dp1 - d12 * dp2) / denominator;
+    const double l3 = (d11 * dp2 - d12 * dp1) / denominator;
+    return {1.0 - l2 - l3, l2, l3};
+}
+
 double Algorithms::interpolateBiquadraticOnTriangle(Coordinate3D pointOfInterest, Coordinate3D c1, double w1,
                                                     Coordinate3D gradC1, Coordinate3D c2, double w2,
                                                     Coordinate3D gradC2, Coordinate3D c3, double w3,
                                                     Coordinate3D gradC3) {
-    //first step: rotate all points in the xy-layer
-    Coordinate3D triVec1(c2 - c1);
-    Coordinate3D triVec2(c3 - c1);
-
-    Coordinate3D normVectorTriangle = triVec1.crossProduct(triVec2);
-    Coordinate3D normVectorCoord = Coordinate3D{normVectorTriangle.x, normVectorTriangle.y, normVectorTriangle.z};
-    SphericCoordinate3D normVectorSpheric = abm::util::toSphericCoordinates(normVectorCoord);
-    double phiNorm = normVectorSpheric.phi;
-    double thetaNorm = normVectorSpheric.theta;
-
-    Coordinate3D poiRotPre = abm::util::rotateAboutThetaAndPhi(pointOfInterest, phiNorm, thetaNorm);
-    Coordinate3D c1Rot = abm::util::rotateAboutThetaAndPhi(c1, phiNorm, thetaNorm);
-    Coordinate3D poiRot{poiRotPre.x, poiRotPre.y, c1Rot.z};
-    Coordinate3D c2Rot = abm::util::rotateAboutThetaAndPhi(c2, phiNorm, thetaNorm);
-    Coordinate3D c3Rot = abm::util::rotateAboutThetaAndPhi(c3, phiNorm, thetaNorm);
-
-    Coordinate3D gradC1Rot = abm::util::rotateAboutThetaAndPhi(gradC1, thetaNorm, phiNorm);
-    Coordinate3D gradC2Rot = abm::util::rotateAboutThetaAndPhi(gradC2, thetaNorm, phiNorm);;
-    Coordinate3D gradC3Rot = abm::util::rotateAboutThetaAndPhi(gradC3, thetaNorm, phiNorm);;
-
-    //reorient vectors as a matter of curvature
-    double gradC1Magn = gradC1Rot.getMagnitude();
-    double gradC2Magn = gradC2Rot.getMagnitude();
-    double gradC3Magn = gradC3Rot.getMagnitude();
-
-    Coordinate3D gradC1RotRescale{gradC1Rot.x, gradC1Rot.y, 0};
-    gradC1RotRescale.setMagnitude(gradC1Magn);
-    Coordinate3D gradC2RotRescale{gradC2Rot.x, gradC2Rot.y, 0};
-    gradC2RotRescale.setMagnitude(gradC2Magn);
-    Coordinate3D gradC3RotRescale{gradC3Rot.x, gradC3Rot.y, 0};
-    gradC3RotRescale.setMagnitude(gradC3Magn);
-
-
-    //step two: find intersection of 2->3 and 1->poi
-    double D = (c3Rot.y - c2Rot.y) * (poiRot.x - c1Rot.x) - (poiRot.y - c1Rot.y) * (c3Rot.x - c2Rot.x);
-
-    double xS = ((c3Rot.x - c2Rot.x) * (poiRot.x * c1Rot.y - c1Rot.x * poiRot.y) -
-                 (poiRot.x - c1Rot.x) * (c3Rot.x * c2Rot.y - c2Rot.x * c3Rot.y)) / D;
-    double yS = ((c1Rot.y - poiRot.y) * (c3Rot.x * c2Rot.y - c2Rot.x * c3Rot.y) -
-                 (c2Rot.y - c3Rot.y) * (poiRot.x * c1Rot.y - c1Rot.x * poiRot.y)) / D;
-    Coordinate3D rS = Coordinate3D{xS, yS, c1Rot.z};
-
-    //step three: interpolate the concentration quadratic
-    double d23 = c2Rot.calculateEuclidianDistance(c3Rot);
-    double d2S = c2Rot.calculateEuclidianDistance(rS);
-    double d1S = c1Rot.calculateEuclidianDistance(rS);
-    double d1p = c1Rot.calculateEuclidianDistance(poiRot);
-
-    Coordinate3D d23_unit(c3Rot - c2Rot);
-    d23_unit.setMagnitude(1.0);
-    Coordinate3D d1S_unit(rS - c1Rot);
-    d1S_unit.setMagnitude(1.0);
-
-    double gradC1_1S = gradC1RotRescale.scalarProduct(d1S_unit);
-    double gradC2_1S = gradC2RotRescale.scalarProduct(d1S_unit);
-    double gradC3_1S = gradC3RotRescale.scalarProduct(d1S_unit);
-
-    double gradCS_1S = gradC2_1S + d2S / d23 * (gradC3_1S - gradC2_1S);
-
-    double a = (gradCS_1S - gradC1_1S) / (2.0 * d1S);
-    double b = gradC1_1S;
-    double c = w1;
-    double wP = a * d1p * d1p + b * d1p + c;
-
-    return wP;
+    const auto l = barycentricCoordinates(pointOfInterest, c1, c2, c3);
+
+    // values at the edge midpoints from the cubic Hermite polynomial of the edge (values and slopes at both ends)
+    const auto midpoint = [](const Coordinate3D &ci, double wi, const Coordinate3D &gradCi,
+                             const Coordinate3D &cj, double wj, const Coordinate3D &gradCj) {
+        return 0.5 * (wi + wj) + 0.125 * (gradCi - gradCj).scalarProduct(cj - ci);
+    };
+    const double w12 = midpoint(c1, w1, gradC1, c2, w2, gradC2);
+    const double w23 = midpoint(c2, w2, gradC2, c3, w3, gradC3);
+    const double w31 = midpoint(c3, w3, gradC3, c1, w1, gradC1);
+
+    return l[0] * (2 * l[0] - 1) * w1 + l[1] * (2 * l[1] - 1) * w2 + l[2] * (2 * l[2] - 1) * w3 +
+           4 * (l[0] * l[1] * w12 + l[1] * l[2] * w23 + l[2] * l[0] * w31);
 }
 
 using namespace boost::numeric::ublas;
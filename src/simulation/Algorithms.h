@@ -11,6 +11,8 @@
 #ifndef ALGORITHMS_H
 #define    ALGORITHMS_H
 
+#include <array>
+
 #include <boost/numeric/ublas/matrix.hpp>
 
 #include "basic/Randomizer.h"
@@ -27,6 +29,11 @@ public:
 
     static double interpolateBilinearOnTriangle(Coordinate3D pointOfInterest, Coordinate3D c1, double w1, Coordinate3D c2, double w2,
                                   Coordinate3D c3, double w3);
+    /// Barycentric coordinates of the projection of a point onto the plane of a triangle
+    static std::array<double, 3> barycentricCoordinates(const Coordinate3D &pointOfInterest, const Coordinate3D &c1,
+                                                        const Coordinate3D &c2, const Coordinate3D &c3);
+    /// Quadratic (P2) interpolation from the values and gradients at the vertices, exact for quadratic fields and
+    /// continuous across the edges of neighbouring triangles (the values at the edge midpoints only depend on the edge)
     static double interpolateBiquadraticOnTriangle(Coordinate3D pointOfInterest, Coordinate3D c1, double w1, Coordinate3D gradC1,
                                      Coordinate3D c2, double w2, Coordinate3D gradC2, Coordinate3D c3, double w3,
                                      Coordinate3D gradC3);
@@ -34,26 +34,20 @@ void BalloonListNHLocator::instantiate(Site *site) {
     initialGridCreation();
 }
 
-std::vector<std::shared_ptr<Collision> > BalloonListNHLocator::getCollisions(Agent *agent) {
+void BalloonListNHLocator::getCollisions(Agent *agent, std::vector<Collision> &collisions) {
 
-    std::vector<SphereRepresentation *>::iterator itCellsSpheres;
-    std::vector<SphereRepresentation *> currentCellsSpheres;
-    currentCellsSpheres = agent->getAgentProperties()->getMorphology()->getAllSpheresOfThis();
-    itCellsSpheres = currentCellsSpheres.begin();
-    std::vector<std::shared_ptr<Collision>> neighbours;
-    SphereRepresentation *currentCellsSphere;
+    agent->getAgentProperties()->getMorphology()->getAllSpheresOfThis(agentSpheres);
+    for (auto *currentCellsSphere: agentSpheres) {
 
-    while (itCellsSpheres != currentCellsSpheres.end()) {
-
-        currentCellsSphere = *itCellsSpheres;
-        std::vector<int> agentGridPoint(3);
+        const auto agentGridPoint = sphereRepresentationAllocator.find(currentCellsSphere);
+        if (agentGridPoint == sphereRepresentationAllocator.end()) {
+            continue;
+        }
         int u, v, w;
 
-        agentGridPoint = sphereRepresentationAllocator[currentCellsSphere];
-
-        u = agentGridPoint[0];
-        v = agentGridPoint[1];
-        w = agentGridPoint[2];
+        u = agentGridPoint->second[0];
+        v = agentGridPoint->second[1];
+        w = agentGridPoint->second[2];
 
         int nHSize;
         nHSize = ceil(thresholdDistance / gridConstant);
@@ -64,23 +58,20 @@ std::vector<std::shared_ptr<Collision> > BalloonListNHLocator::getCollisions(Age
                     if (j >= 0 && j < (gridSize[1])) {
                         for (int k = w - nHSize; k <= w + nHSize; k++) {
                             if (k >= 0 && k < (gridSize[2])) {
-                                checkCollisions(&neighbours, agent, currentCellsSphere, i, j, k);
+                                checkCollisions(&collisions, agent, currentCellsSphere, i, j, k);
                             }
                         }
                     }
                 }
             }
         }
-        itCellsSpheres++;
     }
-    return neighbours;
 }
 
 void BalloonListNHLocator::updateDataStructures(SphereRepresentation *sphereRep) {
 
     if (sphereRepresentationAllocator.find(sphereRep) != sphereRepresentationAllocator.end()) {
-        std::vector<int> sphereGridPoint(3);
-        sphereGridPoint = sphereRepresentationAllocator[sphereRep];
+        const auto sphereGridPoint = sphereRepresentationAllocator[sphereRep];
         unsigned int uOld, vOld, wOld;
         uOld = sphereGridPoint[0];
         vOld = sphereGridPoint[1];
@@ -107,9 +98,8 @@ void BalloonListNHLocator::updateDataStructures(SphereRepresentation *sphereRep)
 void BalloonListNHLocator::removeSphereRepresentation(SphereRepresentation *sphereRep) {
     std::vector<SphereRepresentation *>::iterator toDelete;
 
-    std::vector<int> sphereGridPoint(3);
     if (sphereRepresentationAllocator.find(sphereRep) != sphereRepresentationAllocator.end()) {
-        sphereGridPoint = sphereRepresentationAllocator[sphereRep];
+        const auto sphereGridPoint = sphereRepresentationAllocator[sphereRep];
         unsigned int u, v, w;
         u = sphereGridPoint[0];
         v = sphereGridPoint[1];
@@ -125,7 +115,7 @@ void BalloonListNHLocator::removeSphereRepresentation(SphereRepresentation *sphe
 
 void BalloonListNHLocator::addSphereRepresentation(SphereRepresentation *sphereRep) {
     if (sphereRepresentationAllocator.find(sphereRep) == sphereRepresentationAllocator.end()) {
-        std::vector<int> position(3);
+        std::array<int, 3> position{};
 
         int u, v, w;
         Coordinate3D pos = sphereRep->getPosition();
@@ -190,7 +180,7 @@ void BalloonListNHLocator::initialGridCreation() {
     }
 }
 
-bool BalloonListNHLocator::checkCollisions(std::vector<std::shared_ptr<Collision> > *collisions, Agent *agent,
+bool BalloonListNHLocator::checkCollisions(std::vector<Collision> *collisions, Agent *agent,
                                            SphereRepresentation *sphereRep, int u, int v, int w, bool justCheck) {
     bool returnVal = false;
 
@@ -208,8 +198,7 @@ bool BalloonListNHLocator::checkCollisions(std::vector<std::shared_ptr<Collision
                 if (distance <= minDistance) {
                     returnVal = true;
                     if (!justCheck) {
-                        collisions->push_back(std::make_shared<Collision>(collisionCell, sphereRep, currNeighbour,
-                                                            (minDistance - distance)));
+                        collisions->emplace_back(collisionCell, sphereRep, currNeighbour, (minDistance - distance));
                     }
                 }
             }
@@ -220,27 +209,18 @@ bool BalloonListNHLocator::checkCollisions(std::vector<std::shared_ptr<Collision
 
 bool BalloonListNHLocator::hasCollision(Agent *agent) {
     bool hasOneCollision = false;
-    std::string agentName = agent->getTypeName();
-    std::vector<SphereRepresentation *>::iterator itCellsSpheres;
-    std::vector<SphereRepresentation *> currentCellsSpheres;
-
-    currentCellsSpheres = agent->getAgentProperties()->getMorphology()->getAllSpheresOfThis();
+    agent->getAgentProperties()->getMorphology()->getAllSpheresOfThis(agentSpheres);
+    for (auto *currentCellsSphere: agentSpheres) {
 
-    itCellsSpheres = currentCellsSpheres.begin();
-    std::vector<std::shared_ptr<Collision>> neighbours;
-    SphereRepresentation *currentCellsSphere;
-
-    while (itCellsSpheres != currentCellsSpheres.end()) {
-
-        currentCellsSphere = *itCellsSpheres;
-        std::vector<int> agentGridPoint(3);
+        const auto agentGridPoint = sphereRepresentationAllocator.find(currentCellsSphere);
+        if (agentGridPoint == sphereRepresentationAllocator.end()) {
+            continue;
+        }
         int u, v, w;
 
-        agentGridPoint = sphereRepresentationAllocator[currentCellsSphere];
-
-        u = agentGridPoint[0];
-        v = agentGridPoint[1];
-        w = agentGridPoint[2];
+        u = agentGridPoint->second[0];
+        v = agentGridPoint->second[1];
+        w = agentGridPoint->second[2];
 
         int nHSize;
         nHSize = ceil(thresholdDistance / gridConstant);
@@ -251,7 +231,7 @@ bool BalloonListNHLocator::hasCollision(Agent *agent) {
                     if (j >= 0 && j < ((int) gridSize[1])) {
                         for (int k = w - nHSize; k <= w + nHSize; k++) {
                             if (k >= 0 && k < ((int) gridSize[2])) {
-                                if ((hasOneCollision = checkCollisions(&neighbours, agent, currentCellsSphere, i, j, k, true))) {
+                                if ((hasOneCollision = checkCollisions(nullptr, agent, currentCellsSphere, i, j, k, true))) {
                                     break;
                                 }
                             }
@@ -269,7 +249,6 @@ bool BalloonListNHLocator::hasCollision(Agent *agent) {
         if (hasOneCollision) {
             break;
         }
-        itCellsSpheres++;
     }
 
     return hasOneCollision;
@@ -278,9 +257,7 @@ bool BalloonListNHLocator::hasCollision(Agent *agent) {
 std::vector<Coordinate3D>
 BalloonListNHLocator::getCollisionSpheres(SphereRepresentation *sphereRep, Coordinate3D dirVec) {
     std::vector<Coordinate3D> collisionPositions;
-    std::vector<std::shared_ptr<Collision>> neighbours;
     SphereRepresentation *currentCellsSphere = sphereRep;
-    std::vector<int> agentGridPoint(3);
 
     double newl = ((currentCellsSphere->getRadius()) / dirVec.getMagnitude());
     Coordinate3D sphpos = currentCellsSphere->getPosition();
@@ -288,7 +265,7 @@ BalloonListNHLocator::getCollisionSpheres(SphereRepresentation *sphereRep, Coord
 
     int u, v, w;
 
-    agentGridPoint = sphereRepresentationAllocator[currentCellsSphere];
+    const auto agentGridPoint = sphereRepresentationAllocator[currentCellsSphere];
 
     u = (int) agentGridPoint[0];
     v = (int) agentGridPoint[1];
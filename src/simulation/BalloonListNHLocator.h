@@ -11,6 +11,7 @@
 #ifndef BALLOONLISTNHLOCATOR_H
 #define    BALLOONLISTNHLOCATOR_H
 
+#include <array>
 #include <map>
 #include <boost/thread/condition_variable.hpp>
 
@@ -41,7 +42,8 @@ public:
 
     int controlFunction() final;
     bool hasCollision(Agent *agent) final;
-    std::vector<std::shared_ptr<Collision>> getCollisions(Agent *agent) final;
+    using NeighbourhoodLocator::getCollisions;
+    void getCollisions(Agent *agent, std::vector<Collision> &collisions) final;
     std::vector<Coordinate3D> getCollisionSpheres(SphereRepresentation *sphereRep, Coordinate3D dirVec) final;
     std::string getTypeName() final;
     int getNumberOfAgentTypeInBalloonList(std::string agentType) final;
@@ -49,7 +51,8 @@ public:
 private:
     double gridConstant;
     std::vector<std::vector<std::vector<std::vector<SphereRepresentation *> > > > balloonList;
-    std::map<SphereRepresentation *, std::vector<int> > sphereRepresentationAllocator;
+    std::map<SphereRepresentation *, std::array<int, 3> > sphereRepresentationAllocator;
+    std::vector<SphereRepresentation *> agentSpheres; // reused by the queries
     Coordinate3D lowerPoint;
     Coordinate3D upperPoint;
     int gridSize[3];
@@ -58,7 +61,7 @@ private:
     boost::condition_variable m_cond;
     int checksum;
     void initialGridCreation();
-    bool checkCollisions(std::vector<std::shared_ptr<Collision> > *neighbours,Agent *agent,SphereRepresentation *sphereRep,
+    bool checkCollisions(std::vector<Collision> *neighbours, Agent *agent, SphereRepresentation *sphereRep,
                          int u, int v, int w, bool justCheck = false);
 };
 
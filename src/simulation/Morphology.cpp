@@ -61,18 +61,17 @@ void Morphology::appendAssociatedCellpart(std::unique_ptr<MorphologyElement> mor
 
 std::vector<SphereRepresentation *> Morphology::getAllSpheresOfThis() {
     std::vector<SphereRepresentation *> allSpheresOfThisCell;
+    getAllSpheresOfThis(allSpheresOfThisCell);
+    return allSpheresOfThisCell;
+}
 
-    auto it = morphologyElements.begin();
-
-    while (it != morphologyElements.end()) {
-        std::vector<std::shared_ptr<SphereRepresentation>> sphereReps = (*it)->getSphereRepresentation();
-        for (const auto &ptr: sphereReps) {
-            allSpheresOfThisCell.emplace_back(ptr.get());
+void Morphology::getAllSpheresOfThis(std::vector<SphereRepresentation *> &spheres) {
+    spheres.clear();
+    for (const auto &element: morphologyElements) {
+        for (const auto &ptr: element->getSphereRepresentation()) {
+            spheres.emplace_back(ptr.get());
         }
-        it++;
     }
-
-    return allSpheresOfThisCell;
 }
 
 SphereRepresentation *Morphology::getBasicSphereOfThis() {
@@ -36,6 +36,8 @@ public:
     Cell *getCellThisBelongsTo() { return cell_this_belongs_to_; };
     void appendAssociatedCellpart(std::unique_ptr<MorphologyElement> morphElement);
     std::vector<SphereRepresentation *> getAllSpheresOfThis();
+    /// Fills a buffer of the caller with all spheres
+    void getAllSpheresOfThis(std::vector<SphereRepresentation *> &spheres);
     SphereRepresentation *getBasicSphereOfThis();
     double getVolume();
 
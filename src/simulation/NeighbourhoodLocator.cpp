@@ -24,7 +24,16 @@ void NeighbourhoodLocator::instantiate() {
 }
 
 std::vector<std::shared_ptr<Collision>> NeighbourhoodLocator::getCollisions(Agent *agent) {
-    return {};
+    collisionBuffer.clear();
+    getCollisions(agent, collisionBuffer);
+    std::vector<std::shared_ptr<Collision>> collisions;
+    for (const auto &collision: collisionBuffer) {
+        collisions.push_back(std::make_shared<Collision>(collision));
+    }
+    return collisions;
+}
+
+void NeighbourhoodLocator::getCollisions(Agent *agent, std::vector<Collision> &collisions) {
 }
 
 void NeighbourhoodLocator::updateDataStructures(SphereRepresentation *sphereRep) {
@@ -13,14 +13,15 @@
 
 #include <set>
 #include <algorithm>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "simulation/morphology/SphereRepresentation.h"
+#include "simulation/neighbourhood/Collision.h"
 
 
 class Agent;
-class Collision;
 class Site;
 
 class NeighbourhoodLocator {
@@ -29,7 +30,15 @@ public:
     NeighbourhoodLocator(Site *Site);
     virtual ~NeighbourhoodLocator();
     virtual void instantiate();
-    virtual std::vector<std::shared_ptr<Collision>> getCollisions(Agent *agent);
+    /// Returns the collisions of an agent as shared objects (e.g. for interactions that keep them)
+    std::vector<std::shared_ptr<Collision>> getCollisions(Agent *agent);
+
+    /*!
+     * Appends the collisions of an agent to a buffer of the caller
+     * @param agent Agent object whose spheres are checked
+     * @param collisions vector of Collision that receives the collisions (is not cleared)
+     */
+    virtual void getCollisions(Agent *agent, std::vector<Collision> &collisions);
     virtual bool hasCollision(Agent *agent) { return false; };
     virtual std::vector<Coordinate3D> getCollisionSpheres(SphereRepresentation *sphereRep, Coordinate3D dirVec);
     virtual void updateDataStructures(SphereRepresentation *sphereRep);
@@ -46,6 +55,7 @@ protected:
     double thresholdDistance;
     unsigned int checkInteractionsTimestepInterval;
     Site *site_;
+    std::vector<Collision> collisionBuffer; // reused by getCollisions()
 
 };
 
@@ -10,34 +10,19 @@
 
 #include "simulation/Particle.h"
 #include "simulation/Site.h"
-#include "simulation/movement/RandomWalk.h"
 #include "utils/macros.h"
 
 
-Particle::Particle(unsigned int id, Site *site, const Coordinate3D &pos, double conc, double dc) {
-
-    this->id = id;
-    this->position = std::make_unique<Coordinate3D>();
-    this->initPosition = pos;
-    *this->position = pos;
-    this->concentration = conc;
-    this->dc = dc;
-    this->concChangeInCurTimestep = 0;
-    this->movement = std::make_unique<RandomWalk>(site, site->getNumberOfSpatialDimensions());
-    movement->setSite(site);
-    movement->setCurrentPosition(position.get());
-    particleNeighbourList = std::make_unique<ParticleNeighbourList>(this);
-    isInSite = site->containsPosition(*position);
-}
-
 void Particle::doAllActionsForTimestep(double timestep) {
     diffusePSE(timestep);
 }
 
 double Particle::estimateLowestTimestep() {
-    std::vector<Particle *> nParticle = getParticleNeighbourList()->getNeighbours();
-    std::vector<double> distances = getParticleNeighbourList()->getDistances();
-    std::vector<double> contactAreas = getParticleNeighbourList()->getContactAreas();
+    const auto neighbourList = getParticleNeighbourList();
+    const auto distances = neighbourList.getDistances();
+    const auto contactAreas = neighbourList.getContactAreas();
+    const double dc = getDiffusionCoefficient();
+    const double area = getArea();
 
     unsigned int size = distances.size();
 
@@ -51,20 +36,19 @@ double Particle::estimateLowestTimestep() {
 }
 
 void Particle::diffusePSE(double timestep) {
-    if (isInSite) { //only "in site" grid points are used for the calculations
-        std::vector<Particle *> neighbours = particleNeighbourList->getNeighbours();
-        std::vector<double> preFactorsPSE = particleNeighbourList->getPreFactorsPSE();
-        std::vector<Particle *>::iterator it = neighbours.begin();
-        std::vector<double>::iterator itPF = preFactorsPSE.begin();
+    if (getIsInSite()) { //only "in site" grid points are used for the calculations
+        // the neighbour rows are read in place from the topology, the innermost loop does not allocate
+        const auto neighbourList = getParticleNeighbourList();
+        const auto neighbourIds = neighbourList.getNeighbourIds();
+        const auto preFactorsPSE = neighbourList.getPreFactorsPSE();
+        const auto &concentrations = store->concentrations;
         double curOwnPrefactor = 0;
         double concChangeDiffusion = 0;
-        while (it != neighbours.end()) {
-            concChangeDiffusion += (*it)->getConcentration() * (*itPF);
-            curOwnPrefactor += (*itPF);
-            it++;
-            itPF++;
+        for (size_t k = 0; k < neighbourIds.size(); k++) {
+            concChangeDiffusion += concentrations[neighbourIds[k]] * preFactorsPSE[k];
+            curOwnPrefactor += preFactorsPSE[k];
         }
-        concChangeDiffusion -= concentration * curOwnPrefactor;
+        concChangeDiffusion -= getConcentration() * curOwnPrefactor;
         concChangeDiffusion *= timestep;
 
         addConcentrationChange(concChangeDiffusion);
@@ -72,72 +56,25 @@ void Particle::diffusePSE(double timestep) {
 }
 
 Coordinate3D Particle::getGradient() {
-    Coordinate3D gradient = Coordinate3D();
-    if (isInSite) { //only "in site" grid points are used for the calculations
-        std::vector<Particle *> neighbours = particleNeighbourList->getNeighbours();
-        std::vector<double> preFactorsGradient = particleNeighbourList->getPreFactorsGradient();
-        std::vector<Particle *>::iterator it = neighbours.begin();
-        unsigned int index = 0;
-        while (it != neighbours.end()) {
-
-            //Sukumar et al.
-            Coordinate3D curGradient{(*it)->getPosition() - *position};
-            curGradient *= 0.5 * preFactorsGradient[index] * ((*it)->getConcentration() - concentration);
-            it++;
-            index++;
-            gradient += curGradient;
-        }
+    // the gradients of all particles are evaluated once per concentration update and shared by all queries
+    if (store->gradientsOutdated) {
+        store->topology->evaluateGradients(store->concentrations, store->inSiteIds, store->gradients);
+        store->gradientsOutdated = false;
     }
-
-    return gradient;
+    return store->gradients[id];
 }
 
 double Particle::getGradientStrength() {
-    Coordinate3D gradient = Coordinate3D();
-    if (isInSite) {
-        std::vector<Particle *> neighbours = particleNeighbourList->getNeighbours();
-        std::vector<double> preFactorsGradient = particleNeighbourList->getPreFactorsGradient();
-
-        std::vector<Particle *>::iterator it = neighbours.begin();
-        unsigned int index = 0;
-        while (it != neighbours.end()) {
-
-            //Sukumar et al.
-            Coordinate3D curGradient{(*it)->getPosition() - *position};
-            curGradient *= 0.5 * preFactorsGradient[index] * ((*it)->getConcentration() - concentration);
-            it++;
-            index++;
-            gradient += curGradient;
-        }
-    }
-
-    return gradient.getMagnitude();
+    return getGradient().getMagnitude();
 }
 
 double Particle::getGradientDirection() {
-    Coordinate3D gradient = Coordinate3D();
-
-    if (isInSite) {
-        std::vector<Particle *> neighbours = particleNeighbourList->getNeighbours();
-        std::vector<double> preFactorsGradient = particleNeighbourList->getPreFactorsGradient();
-        std::vector<Particle *>::iterator it = neighbours.begin();
-        unsigned int index = 0;
-        while (it != neighbours.end()) {
-
-            //Sukumar et al.
-            Coordinate3D curGradient{(*it)->getPosition() - *position};
-            curGradient *= 0.5 * preFactorsGradient[index] * ((*it)->getConcentration() - concentration);
-            it++;
-            index++;
-            gradient += curGradient;
-        }
-    }
-
+    Coordinate3D gradient = getGradient();
     gradient.setMagnitude(1.0);
     Coordinate3D gradientPos = getPosition();
     gradientPos += gradient;
 
-    SphericCoordinate3D ownPos = abm::util::toSphericCoordinates(*position);
+    SphericCoordinate3D ownPos = abm::util::toSphericCoordinates(getPosition());
     SphericCoordinate3D goalPos = abm::util::toSphericCoordinates(gradientPos);
 
     //get the alpha turning angle by taking the spheric coordinates as input:
@@ -182,7 +119,9 @@ double Particle::getGradientDirection() {
 double Particle::applyConcentrationChange(double time_delta) {
 
     double relChange = 0;
-    if (isInSite) { //only "in site" grid points are used for the calculations
+    if (getIsInSite()) { //only "in site" grid points are used for the calculations
+        double &concentration = store->concentrations[id];
+        double &concChangeInCurTimestep = store->concentrationChanges[id];
         if (concentration > 0) {
             relChange = fabs(concChangeInCurTimestep / (concentration * time_delta));
         }
@@ -191,22 +130,3 @@ double Particle::applyConcentrationChange(double time_delta) {
     }
     return relChange;
 }
-
-void Particle::setLabel() {
-    if (isInSite) {
-        isBoundaryParticle = false;
-    } else {
-        std::vector<Particle *> neighbours = particleNeighbourList->getNeighbours();
-        std::vector<Particle *>::iterator itN = neighbours.begin();
-
-        isBoundaryParticle = false;
-
-        while (itN != neighbours.end()) {
-            if ((*itN)->isInSite) {
-                isBoundaryParticle = true;
-                break;
-            }
-            itN++;
-        }
-    }
-}
\ No newline at end of file
@@ -11,21 +11,20 @@
 #ifndef PARTICLE_H
 #define    PARTICLE_H
 
-#include <memory>
+#include <vector>
 
 #include "basic/Coordinate3D.h"
 #include "basic/SphericCoordinate3D.h"
 #include "simulation/ParticleNeighbourList.h"
-
-class Site;
-class RandomWalk;
+#include "simulation/ParticleStore.h"
 
 class Particle {
 
 public:
     /// Class for modelling particles in a 'Lagrangian' way
+    /// A Particle is a lightweight handle (store and id) into the ParticleStore of a run and is copied by value
     Particle() = default;
-    Particle(unsigned int id, Site *site, const Coordinate3D &pos, double conc, double dc);
+    Particle(ParticleStore *store, unsigned int id) : store(store), id(id) {};
 
     /*!
      * Performs all actions for one timestep for one particle
@@ -43,14 +42,7 @@ public:
      * Adds concentration change to particle
      * @param value Double that contains value that is added to concentration of particle
      */
-    void addConcentrationChange(double value) { concChangeInCurTimestep += value; }
-
-    /*!
-     * Adds and maintains neighbour list for one particle
-     * @param p Particle that contains particle that is added to neighbour list
-     * @param contactArea Double that contains contacting area
-     */
-    void addNeighbour(Particle *p, double contactArea) { particleNeighbourList->addNeighbour(p, contactArea); };
+    void addConcentrationChange(double value) { store->concentrationChanges[id] += value; }
 
     /*!
      * Applys concentration change for timestep
@@ -65,36 +57,33 @@ public:
      */
     double estimateLowestTimestep();
 
-    void setArea(double areaP) { area = areaP; };
-    void setLabel();
+    /// Returns the gradient of the concentration at the particle, evaluated for all particles on the first query
+    /// after the concentrations changed (the ParticleManager marks the gradients as outdated)
+    Coordinate3D getGradient();
     double getGradientStrength();
     double getGradientDirection();
-    double getDiffusionCoefficient() const { return dc; };
-    double *getConcentrationRef() { return &concentration; };
-    Coordinate3D getPosition() { return *position; };
-    Coordinate3D getGradient();
-    ParticleNeighbourList *getParticleNeighbourList() { return particleNeighbourList.get(); }
+    double getDiffusionCoefficient() const { return store->topology->getDiffusionCoefficient(); };
+    double *getConcentrationRef() { return &store->concentrations[id]; };
+    const Coordinate3D &getPosition() const { return store->topology->getPositions()[id]; };
+    ParticleNeighbourList getParticleNeighbourList() const { return ParticleNeighbourList(store, id); }
     [[nodiscard]] unsigned int getId() const { return id; };
-    [[nodiscard]] double getArea() const { return area; };
-    [[nodiscard]] double getConcentration() const { return concentration; };
-    [[nodiscard]] bool getIsInSite() const { return isInSite; };
-    [[nodiscard]] bool getIsAtBoundary() const { return isBoundaryParticle; };
+    [[nodiscard]] unsigned int getInputId() const { return store->topology->getInputIds()[id]; };
+    [[nodiscard]] double getArea() const { return store->topology->getAreas()[id]; };
+    [[nodiscard]] double getConcentration() const { return store->concentrations[id]; };
+    /// Returns the concentration of a species, species 0 is the chemokine and 1... are the additional species
+    [[nodiscard]] double getSpeciesConcentration(unsigned int species) const {
+        return species == 0 ? store->concentrations[id]
+                            : store->speciesConcentrations[id * store->numberOfAdditionalSpecies + species - 1];
+    };
+    [[nodiscard]] bool getIsInSite() const { return store->inSite[id] != 0; };
+    [[nodiscard]] bool getIsAtBoundary() const { return store->atBoundary[id] != 0; };
+
+    bool operator==(const Particle &other) const { return store == other.store && id == other.id; }
+    bool operator!=(const Particle &other) const { return !(*this == other); }
 
 private:
-    unsigned int id;
-    Site *site{};
-    bool isStatic{};
-    bool isInSite;
-    bool isBoundaryParticle{};
-    double area{};
-    std::unique_ptr<Coordinate3D> position;
-    Coordinate3D initPosition;
-    double concentration;
-    double concChangeInCurTimestep;
-    std::unique_ptr<RandomWalk> movement;
-    double dc;
-    std::unique_ptr<ParticleNeighbourList> particleNeighbourList;
-
+    ParticleStore *store{};
+    unsigned int id{};
 };
 
 #endif    /* PARTICLE_H */
@@ -9,33 +9,130 @@
 //  See the LICENSE file provided with this code for the full license.
 
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <map>
 
 #include "simulation/ParticleManager.h"
+#include "simulation/ParticleMeshGenerator.h"
 #include "simulation/Site.h"
 #include "analyser/InSituMeasurements.h"
 #include "utils/macros.h"
 #include "simulation/AgentManager.h"
 
+namespace {
+// 64 bit FNV-1a over the bytes of the ids (little endian), the same on every platform and compiler
+uint64_t fnv1aDigest(const std::vector<unsigned int> &ids) {
+    uint64_t digest = 14695981039346656037ULL;
+    for (const auto id: ids) {
+        for (int byte = 0; byte < 4; byte++) {
+            digest ^= (id >> (8 * byte)) & 0xFFu;
+            digest *= 1099511628211ULL;
+        }
+    }
+    return digest;
+}
+}
 
 ParticleManager::ParticleManager(Site *site) {
     this->site = site;
-    noOfParticles = 0;
-    idHandling = 0;
     allowHigherDT = false;
-    conidiumParticle = 0;
 }
 
 void ParticleManager::initializeParticles(Site *site,
                                           const abm::util::SimulationParameters::ParticleManagerParameters &parameters,
-                                          const std::string &input_dir) {
+                                          const std::string &input_dir,
+                                          std::shared_ptr<const ParticleTopology> particleTopology) {
 
     //initDistribution: 0-random, 1-every agent in one place at beginning
     dc = parameters.diffusion_constant;
     particleInputDelauneyFile = parameters.particle_delauney_input_file;
+    numberOfGeneratedParticles = parameters.number_of_particles;
+    particles.topology = std::move(particleTopology);
     drawIsolines = parameters.draw_isolines;
+    if (parameters.diffusion_backend == "csr") {
+        diffusionBackend = DiffusionBackend::CSR;
+    } else if (parameters.diffusion_backend == "simd") {
+        diffusionBackend = DiffusionBackend::SIMD;
+        diffusionMatrix.setInstructionSet(DiffusionMatrix::instructionSetFromString(parameters.simd_instruction_set));
+    } else if (parameters.diffusion_backend == "particle") {
+        diffusionBackend = DiffusionBackend::PARTICLE;
+    } else {
+        ERROR_STDERR("Unknown diffusion backend: " << parameters.diffusion_backend);
+        exit(1);
+    }
+    diffusionThreads = std::max(1, parameters.diffusion_threads);
+    if (parameters.mesh_interpolation == "quadratic") {
+        meshInterpolation = MeshInterpolation::QUADRATIC;
+    } else if (parameters.mesh_interpolation == "linear") {
+        meshInterpolation = MeshInterpolation::LINEAR;
+    } else if (parameters.mesh_interpolation == "none") {
+        meshInterpolation = MeshInterpolation::NONE;
+    } else {
+        ERROR_STDERR("Unknown mesh interpolation: " << parameters.mesh_interpolation);
+        exit(1);
+    }
+    if (parameters.steady_state_detection == "max") {
+        steadyStateDetection = SteadyStateDetection::RESIDUAL_MAX;
+    } else if (parameters.steady_state_detection == "l2") {
+        steadyStateDetection = SteadyStateDetection::RESIDUAL_L2;
+    } else if (parameters.steady_state_detection == "lookup") {
+        steadyStateDetection = SteadyStateDetection::LOOKUP;
+    } else {
+        ERROR_STDERR("Unknown steady state detection: " << parameters.steady_state_detection);
+        exit(1);
+    }
+    steadyStateTolerance = parameters.steady_state_tolerance;
+    steadyStateWindow = parameters.steady_state_window;
+    if (!parameters.steady_state_library.empty()) {
+        auto library = boost::filesystem::path(parameters.steady_state_library);
+        if (library.is_relative()) {
+            library = boost::filesystem::path(input_dir).append(parameters.steady_state_library);
+        }
+        steadyStateLibrary.setDirectory(library.string());
+    }
+    diffusionMatrix.setNumberOfThreads(diffusionThreads);
+    if (parameters.diffusion_solver != "explicit") {
+        implicitDiffusion = true;
+        implicitSolver.setScheme(ImplicitDiffusionSolver::schemeFromString(parameters.diffusion_solver));
+        implicitSolver.setTolerance(parameters.solver_tolerance);
+    }
+    // the implicit solver couples all particles in every timestep, there is no front to restrict the work to
+    activeSetDiffusion = parameters.diffusion_active_set && !implicitDiffusion;
+    activeSetThreshold = parameters.active_set_threshold;
+    diffusionMatrix.setPrecision(DiffusionMatrix::precisionFromString(parameters.diffusion_precision));
+    // the particle and simd backends exchange the double field directly, the implicit solver needs it for convergence
+    if (diffusionMatrix.getPrecision() == DiffusionMatrix::Precision::SINGLE &&
+        (diffusionBackend != DiffusionBackend::CSR || implicitDiffusion)) {
+        ERROR_STDERR("Single diffusion precision requires the explicit csr diffusion backend");
+        exit(1);
+    }
 
     particleSecretionMoleculePerCellMin = parameters.molecule_secretion_per_cell; //6000.0;
+    speciesDCRatios.clear();
+    speciesSecretionRatios.clear();
+    for (const auto &species: parameters.additional_species) {
+        // the timestep is adapted to the dc of the chemokine, a faster species would make the explicit scheme unstable
+        if (species.diffusion_constant > dc) {
+            ERROR_STDERR("Additional species " << species.name << " diffuses faster than the chemokine");
+            exit(1);
+        }
+        speciesDCRatios.push_back(dc > 0 ? species.diffusion_constant / dc : 0.0);
+        // the AECs that secrete the chemokine secrete all species
+        speciesSecretionRatios.push_back(particleSecretionMoleculePerCellMin > 0 ?
+                                         species.molecule_secretion_per_cell / particleSecretionMoleculePerCellMin : 0.0);
+    }
+    if (!speciesDCRatios.empty() &&
+        (diffusionBackend != DiffusionBackend::CSR || implicitDiffusion || activeSetDiffusion ||
+         steadyStateLibrary.isActive() || diffusionMatrix.getPrecision() != DiffusionMatrix::Precision::DOUBLE)) {
+        ERROR_STDERR("Additional species require the explicit csr diffusion backend in double precision "
+                     "without active set and steady state library");
+        exit(1);
+    }
+    if (speciesDCRatios.size() > DiffusionMatrix::maxAdditionalSpecies) {
+        ERROR_STDERR("At most " << DiffusionMatrix::maxAdditionalSpecies << " additional species are supported");
+        exit(1);
+    }
 
     particleBalloonList = std::make_unique<StaticBalloonList>(10.61, site->getLowerLimits(), site->getUpperLimits());
     particleBalloonList->setThreshold(10.6);
@@ -50,70 +147,106 @@ void ParticleManager::triangulationFromDirectInput(Site *site,
     auto dc = parameters.diffusion_constant;
     double R = site->getRadius();
 
-    std::vector<Coordinate3D> coordinates;
-    InputConfiguration icParticles = InputConfiguration(boost::filesystem::path(input_dir).append(particleInputDelauneyFile).string());
-    XMLNode particlesForInput = icParticles.getRootNode().getChildNode("Particles");
-
-    // extract particles first
-    for (int i = 0; i < particlesForInput.nChildNode(); i++) {
-        XMLNode curParticle = particlesForInput.getChildNode(i);
-        std::string name = curParticle.getName();
-        if (name.compare("Particle") == 0) {
-
-            Coordinate3D position = InputConfiguration::getCoordinateDataFieldValueByName(&curParticle, "position");
-            double area = InputConfiguration::getDoubleDataFieldValueByName(&curParticle, "area");
-            double conc = InputConfiguration::getDoubleDataFieldValueByName(&curParticle, "concentration");
-            coordinates.push_back(position);
-
-            auto particle = createParticle(site, position, conc, dc);
-            particle->setArea(area);
-        }
-    }
-
-    // extract neighbours of each particle and set that shit!
-    for (int i = 0; i < particlesForInput.nChildNode(); i++) {
-        XMLNode curParticle = particlesForInput.getChildNode(i);
-        std::string name = curParticle.getName();
-        if (name.compare("Particle") == 0) {
-            unsigned int id = InputConfiguration::getUIntDataFieldValueByName(&curParticle, "id");
-            Particle *p = particleById[id];
-            XMLNode interactionPartners = curParticle.getChildNode("Interactions");
-            for (int j = 0; j < interactionPartners.nChildNode(); j++) {
-                XMLNode curInteractionPartner = interactionPartners.getChildNode(j);
-                std::string partnerNodeName = curInteractionPartner.getName();
-                if (partnerNodeName == "Particle") {
-                    unsigned int partnerId = InputConfiguration::getUIntDataFieldValueByName(&curInteractionPartner,"id");
-                    double contactArea = InputConfiguration::getDoubleDataFieldValueByName(&curInteractionPartner, "contact");
-                    Particle *pNeighbour = particleById[partnerId];
-                    p->addNeighbour(pNeighbour, contactArea);
-                }
-            }
+    // the mesh is shared by all runs of the simulator, only the concentrations are owned by this run
+    if (!particles.topology && numberOfGeneratedParticles > 0) {
+        particles.topology = ParticleTopology::fromMesh(
+                ParticleMeshGenerator::sphere(numberOfGeneratedParticles, R, site->getCenterPosition()), dc,
+                ParticleTopology::orderingFromString(parameters.particle_ordering));
+    } else if (!particles.topology) {
+        particles.topology = ParticleTopology::load(
+                boost::filesystem::path(input_dir).append(particleInputDelauneyFile).string(), dc,
+                ParticleTopology::orderingFromString(parameters.particle_ordering));
+    }
+    const auto &topology = *particles.topology;
+    const auto numberOfParticles = static_cast<unsigned int>(topology.getNumberOfParticles());
+    particles.concentrations = topology.getInitialConcentrations();
+    particles.concentrationChanges.assign(numberOfParticles, 0);
+    aecOwnerOfParticle.assign(numberOfParticles, -1);
+    particles.numberOfAdditionalSpecies = static_cast<unsigned int>(speciesDCRatios.size());
+    particles.speciesConcentrations.assign(numberOfParticles * particles.numberOfAdditionalSpecies, 0);
+    particles.speciesConcentrationChanges.assign(numberOfParticles * particles.numberOfAdditionalSpecies, 0);
+    particles.inSite.resize(numberOfParticles);
+    particles.atBoundary.assign(numberOfParticles, 0);
+    particles.inSiteIds.clear();
+    particles.gradients.assign(numberOfParticles, Coordinate3D());
+    particles.gradientsOutdated = true;
+    for (unsigned int id = 0; id < numberOfParticles; id++) {
+        particles.inSite[id] = site->containsPosition(topology.getPositions()[id]);
+        if (particles.inSite[id]) {
+            particles.inSiteIds.push_back(id);
         }
     }
-    computeMinTimestepDistribution();
-
-    // draw Isolines in Visualisation
-    if (drawIsolines) extractTriangles();
 
-    // set particles as inside or outside the environment
+    // set particles as inside or outside the environment, "out of site" particles with an "in site" neighbour are at the boundary
     int inside = 0, boundary = 0, outside = 0;
-
-    auto itP = allParticles.begin();
-    while (itP != allParticles.end()) {
-
-        (*itP)->setLabel();
-
-        if ((*itP)->getIsInSite()) {
+    const auto &neighbourOffsets = topology.getNeighbourOffsets();
+    const auto &neighbourIds = topology.getNeighbourIds();
+    for (unsigned int id = 0; id < numberOfParticles; id++) {
+        if (particles.inSite[id]) {
             inside++;
-        } else {
-            if ((*itP)->getIsAtBoundary()) {
-                boundary++;
-            } else {
-                outside++;
+            continue;
+        }
+        for (auto k = neighbourOffsets[id]; k < neighbourOffsets[id + 1]; k++) {
+            if (particles.inSite[neighbourIds[k]]) {
+                particles.atBoundary[id] = 1;
+                break;
             }
         }
+        if (particles.atBoundary[id]) {
+            boundary++;
+        } else {
+            outside++;
+        }
+    }
 
-        itP++;
+    // only the particles of the diffusion and their boundary are active, the remaining particles are never visited again
+    // filled in input order, so queries return the same particles for every particle ordering
+    activeInputIds.clear();
+    const auto &idsOfInputIds = topology.getIdsOfInputIds();
+    for (unsigned int inputId = 0; inputId < numberOfParticles; inputId++) {
+        const auto id = idsOfInputIds[inputId];
+        if (particles.inSite[id] || particles.atBoundary[id]) {
+            particleBalloonList->addCoordinateWithId(topology.getPositions()[id], id);
+            activeInputIds.push_back(inputId);
+        }
+    }
+
+    // an agent with an active particle in its reach (at most the grid constant) is never farther away from an "out of
+    // site" particle than twice the reach, only these particles are counted by countOutOfSiteParticles()
+    outOfSitePositions.clear();
+    std::vector<unsigned int> activeParticles;
+    particleBalloonList->setThreshold(2 * 10.61);
+    for (unsigned int id = 0; id < numberOfParticles; id++) {
+        if (particles.inSite[id] || particles.atBoundary[id]) {
+            continue;
+        }
+        activeParticles.clear();
+        particleBalloonList->getInteractions(topology.getPositions()[id], activeParticles);
+        if (!activeParticles.empty()) {
+            outOfSitePositions.push_back(topology.getPositions()[id]);
+        }
+    }
+    particleBalloonList->setThreshold(10.6);
+    computeMinTimestepDistribution();
+
+    // draw Isolines in Visualisation
+    if (drawIsolines) extractTriangles();
+
+    // the mesh topology is fixed from here on, so the PSE operator is compiled once
+    if (diffusionBackend != DiffusionBackend::PARTICLE || activeSetDiffusion) {
+        diffusionMatrix.compile(particles);
+        diffusionMatrix.synchronize(particles.concentrations);
+    }
+    if (activeSetDiffusion) {
+        activeSet.initialize(diffusionMatrix, particles.concentrations, activeSetThreshold);
+    }
+    if (diffusionBackend == DiffusionBackend::SIMD) {
+        nextConcentrations.assign(particles.concentrations.size(), 0);
+        secretionRates.assign(particles.concentrations.size(), 0);
+        secretionRatesOutdated = true;
+    }
+    if (implicitDiffusion || steadyStateLibrary.isActive()) {
+        implicitSolver.compile(particles);
     }
 
     DEBUG_STDOUT("particle statistics: inside:" + std::to_string(inside) +
@@ -121,179 +254,182 @@ void ParticleManager::triangulationFromDirectInput(Site *site,
                  " outside:" + std::to_string(outside) +
                  " sum:" + std::to_string(inside + outside + boundary));
 
-    std::shared_ptr<Particle> pAtMPI = nullptr;
     double areaFull = 4 * M_PI * R * R;
     double areaMeasure = 0;
-
-    std::vector<double> contactAreas, distances;
-    while (itP != allParticles.end()) {
-        areaMeasure += (*itP)->getArea();
-        contactAreas = (*itP)->getParticleNeighbourList()->getContactAreas();
-        distances = (*itP)->getParticleNeighbourList()->getDistances();
-        auto itPN = (*itP)->getParticleNeighbourList()->getNeighbours().begin();
-        int idx = 0;
-        while (itPN != (*itP)->getParticleNeighbourList()->getNeighbours().end()) {
-            if (distances[idx] == 0) {
-                DEBUG_STDOUT(
-                        "distance " + std::to_string(distances[idx]) +
-                        " for ids:" + std::to_string((*itP)->getId()) + " " +
-                        std::to_string((*itPN)->getId()) + " " +
-                        std::to_string((*itP)->getPosition().calculateEuclidianDistance(
-                                (*itPN)->getPosition())) + " ");
+    for (unsigned int id = 0; id < numberOfParticles; id++) {
+        areaMeasure += topology.getAreas()[id];
+        for (auto k = neighbourOffsets[id]; k < neighbourOffsets[id + 1]; k++) {
+            if (topology.getDistances()[k] == 0) {
+                DEBUG_STDOUT("distance 0 for ids:" + std::to_string(id) + " " + std::to_string(neighbourIds[k]));
             }
-            itPN++;
-            idx++;
         }
-        itP++;
     }
     DEBUG_STDOUT("area correct:" + std::to_string(areaFull) +
                  " measured/computed from cells:" + std::to_string(areaMeasure) +
                  " rel.Error:" + std::to_string(1 - areaMeasure / areaFull));
 }
 
-std::shared_ptr<Particle> ParticleManager::getParticleByPosition(Coordinate3D pos) {
-    std::shared_ptr<Particle> p = nullptr;
-    for (auto itP: allParticles){
-        double dist = itP->getPosition().calculateEuclidianDistance(pos);
-        if (dist < 0.001) {
-            p = itP;
-            break;
+std::optional<Particle> ParticleManager::getParticleByPosition(Coordinate3D pos) {
+    for (unsigned int id = 0; id < getNumberOfParticles(); id++) {
+        if (particles.topology->getPositions()[id].calculateEuclidianDistance(pos) < 0.001) {
+            return getParticle(id);
         }
     }
-    return p;
+    return std::nullopt;
 }
 
 void ParticleManager::computeMinTimestepDistribution() {
     double minTimestep = 1000000, timestep{};
-    for (auto itP: allParticles){
-        timestep = itP->estimateLowestTimestep();
+    for (const auto id: particles.inSiteIds) {
+        timestep = getParticle(id).estimateLowestTimestep();
         if (timestep < minTimestep)
             minTimestep = timestep;
     }
-    INFO_STDOUT("maximum timestep that is possible for stability reasons: " + std::to_string(minTimestep));
+    if (implicitDiffusion) {
+        INFO_STDOUT("implicit diffusion is unconditionally stable, explicit timestep limit: " + std::to_string(minTimestep));
+    } else {
+        INFO_STDOUT("maximum timestep that is possible for stability reasons: " + std::to_string(minTimestep));
+    }
 }
 
 void ParticleManager::inputOfParticles(double time_delta) {
+    cleanUpChemotaxis();
+    insertConcentrationAtArea(site, time_delta);
+}
 
+void ParticleManager::cleanUpChemotaxis() {
     if (clean_chemotaxis && !site->getLargeTimestepActive()) {
         DEBUG_STDOUT("Start chemotaxis cleanup");
         cleanUpAllParticles();
         clean_chemotaxis = false;
     }
-    insertConcentrationAtArea(site, time_delta);
 }
 
 void ParticleManager::insertConcentrationAtArea(Site *site, double time_delta) {
     if (aecParticles.empty() && particleSecretionMoleculePerCellMin > 0) {
-        sumAreaAECParticles = 0;
-        aecParticlesCells.clear();
-        aecParticlesCells.clear();
-        for (int i = 0; i < 100; i++) {
-            sumAreaAEcParticlesCells[i] = 0;
-            aecSecretionratePerGrid[i] = 0;
-        }
-        std::vector<Agent *> allConidia = site->getAgentManager()->getAllConidia();
-        for (size_t i = 0; i < allConidia.size(); i++) {
-            bool overAECT1;
-            if (!allConidia.at(i)->isDeleted()) {
-                overAECT1 = site->overAECT1(abm::util::toSphericCoordinates(allConidia.at(i)->getPosition()));
-                SphericCoordinate3D posObstacleAEC = abm::util::toSphericCoordinates(allConidia.at(i)->getPosition());
-                std::vector<unsigned int> potentialAECParticles;
-                int ID;
-                if (overAECT1) {
-                    ID = get_closest_AEC_ID(allConidia.at(i)->getPosition(), 1);
-                    INFO_STDOUT("Found Conidia " + std::to_string(i) + " at position " << allConidia.at(i)->getPosition().printCoordinates() << " over AECI " + std::to_string(ID));
-                    particleBalloonList->setThreshold(48.0);
-                } else {
-                    ID = get_closest_AEC_ID(allConidia.at(i)->getPosition(), 2);
-                    INFO_STDOUT("Found Conidia " + std::to_string(i) + " at position " << allConidia.at(i)->getPosition().printCoordinates() << " over AECII " + std::to_string(ID));
-                    particleBalloonList->setThreshold(6.61);
-                }
-                particleBalloonList->getInteractions(abm::util::toCartesianCoordinates(posObstacleAEC), potentialAECParticles);
-
-                auto itP = potentialAECParticles.begin();
-                while (itP != potentialAECParticles.end()) {
-                    auto currentParticle = allParticles[(*itP)];
-                    if (currentParticle->getIsInSite()) {
-                        if (site->onAECTObstacleCell(currentParticle->getPosition())){
-                            if (std::find(aecParticles.begin(), aecParticles.end(), currentParticle) ==
-                                aecParticles.end()) {
-                                aecParticlesCells.push_back(ID);
-                                sumAreaAEcParticlesCells[ID] += currentParticle->getArea();
-                                aecParticles.push_back(currentParticle);
-                                sumAreaAECParticles += currentParticle->getArea();
-                            }
-
-                        }
-                    }
-                    itP++;
-                }
-            }
-        }
+        collectAECParticles(site, time_delta);
+    }
 
-        for (int i = 0; i < 100; i++) {
-            if (sumAreaAEcParticlesCells[i] > 0) {
-                DEBUG_STDOUT("i have cell " << i << " with an area of " << sumAreaAEcParticlesCells[i]);
-                double secretionrate = particleSecretionMoleculePerCellMin /
-                                       sumAreaAEcParticlesCells[i] * time_delta;
-                aecSecretionratePerGrid[i] = secretionrate;
-                DEBUG_STDOUT("this cell gets an per-grid secretion rate of " +
-                             std::to_string(secretionrate));
+    // the fused kernel adds the secretion itself, it only needs the dense secretion rate of each particle
+    if (diffusionBackend == DiffusionBackend::SIMD && !implicitDiffusion && !activeSetDiffusion) {
+        if (secretionRatesOutdated) {
+            std::fill(secretionRates.begin(), secretionRates.end(), 0.0);
+            for (size_t i = 0; i < aecParticles.size(); i++) {
+                secretionRates[aecParticles[i].getId()] = aecSecretionratePerGrid[aecParticlesCells[i]];
             }
+            secretionRatesOutdated = false;
         }
+        return;
     }
 
+    const auto numberOfSpecies = particles.numberOfAdditionalSpecies;
     for (size_t i = 0; i < aecParticles.size(); i++) {
         int particleCell = aecParticlesCells[i];
-        aecParticles[i]->addConcentrationChange(aecSecretionratePerGrid[particleCell]);
-        if (aecParticles[i]->getId() % 100 == 0) {
+        aecParticles[i].addConcentrationChange(aecSecretionratePerGrid[particleCell]);
+        for (unsigned int s = 0; s < numberOfSpecies; s++) {
+            particles.speciesConcentrationChanges[aecParticles[i].getId() * numberOfSpecies + s] +=
+                    aecSecretionratePerGrid[particleCell] * speciesSecretionRatios[s];
         }
     }
 
 }
 
-std::shared_ptr<Particle> ParticleManager::createParticle(Site *site,
-                                                          Coordinate3D pos,
-                                                          double conc,
-                                                          double dc) {
-    auto particle = std::make_shared<Particle>(idHandling, site, pos, conc, dc);
-    allParticles.push_back(particle);
-    particleBalloonList->addCoordinateWithId(pos, idHandling);
-    particleById[idHandling] = particle.get();
-    noOfParticles++;
-    idHandling++;
+void ParticleManager::collectAECParticles(Site *site, double time_delta) {
+    sumAreaAECParticles = 0;
+    aecParticlesCells.clear();
+    aecCells.clear();
+    std::fill(sumAreaAEcParticlesCells.begin(), sumAreaAEcParticlesCells.end(), 0.0);
+    std::fill(aecSecretionratePerGrid.begin(), aecSecretionratePerGrid.end(), 0.0);
+    std::vector<Agent *> allConidia = site->getAgentManager()->getAllConidia();
+    for (size_t i = 0; i < allConidia.size(); i++) {
+        bool overAECT1;
+        if (!allConidia.at(i)->isDeleted()) {
+            overAECT1 = site->overAECT1(abm::util::toSphericCoordinates(allConidia.at(i)->getPosition()));
+            SphericCoordinate3D posObstacleAEC = abm::util::toSphericCoordinates(allConidia.at(i)->getPosition());
+            std::vector<unsigned int> potentialAECParticles;
+            int ID;
+            if (overAECT1) {
+                ID = get_closest_AEC_ID(allConidia.at(i)->getPosition(), 1);
+                INFO_STDOUT("Found Conidia " + std::to_string(i) + " at position " << allConidia.at(i)->getPosition().printCoordinates() << " over AECI " + std::to_string(ID));
+                particleBalloonList->setThreshold(48.0);
+            } else {
+                ID = get_closest_AEC_ID(allConidia.at(i)->getPosition(), 2);
+                INFO_STDOUT("Found Conidia " + std::to_string(i) + " at position " << allConidia.at(i)->getPosition().printCoordinates() << " over AECII " + std::to_string(ID));
+                particleBalloonList->setThreshold(6.61);
+            }
+            if (ID < 0) {
+                continue;
+            }
+            particleBalloonList->getInteractions(abm::util::toCartesianCoordinates(posObstacleAEC), potentialAECParticles);
+            const int aecType = overAECT1 ? 1 : 2;
+            aecCells.insert(aecIndex(aecType, ID));
+
+            auto itP = potentialAECParticles.begin();
+            while (itP != potentialAECParticles.end()) {
+                auto currentParticle = getParticle(*itP);
+                if (currentParticle.getIsInSite()) {
+                    if (site->onAECTObstacleCell(currentParticle.getPosition())){
+                        addAECParticle(currentParticle.getId(), aecType, ID);
+                    }
+                }
+                itP++;
+            }
+        }
+    }
+    computeAECSecretionRates(time_delta);
+}
 
-    return particle;
+void ParticleManager::addAECParticle(unsigned int id, int type, int aecId) {
+    // a particle secretes for the AEC of the first conidium that covers it
+    if (aecOwnerOfParticle[id] >= 0) {
+        return;
+    }
+    const int cell = aecIndex(type, aecId);
+    auto particle = getParticle(id);
+    aecOwnerOfParticle[id] = cell;
+    aecParticlesCells.push_back(cell);
+    sumAreaAEcParticlesCells[cell] += particle.getArea();
+    aecParticles.push_back(particle);
+    sumAreaAECParticles += particle.getArea();
 }
 
-void ParticleManager::replaceParticle(Site *site, Particle *particle, std::shared_ptr<Particle> newParticle) {
-    std::replace_if(allParticles.begin(),
-                    allParticles.end(),
-                    [particle](const auto &ptr) { return particle == ptr.get(); },
-                    newParticle);
-    if (newParticle == 0) noOfParticles--;
+void ParticleManager::computeAECSecretionRates(double time_delta) {
+    for (size_t i = 0; i < sumAreaAEcParticlesCells.size(); i++) {
+        if (sumAreaAEcParticlesCells[i] > 0) {
+            DEBUG_STDOUT("i have cell " << i << " with an area of " << sumAreaAEcParticlesCells[i]);
+            double secretionrate = particleSecretionMoleculePerCellMin /
+                                   sumAreaAEcParticlesCells[i] * time_delta;
+            aecSecretionratePerGrid[i] = secretionrate;
+            DEBUG_STDOUT("this cell gets an per-grid secretion rate of " +
+                         std::to_string(secretionrate));
+        }
+    }
+    secretionRatesOutdated = true;
 }
 
 void ParticleManager::cleanUpAllParticles() {
+    for (const auto &particle: aecParticles) {
+        aecOwnerOfParticle[particle.getId()] = -1;
+    }
     aecParticles.clear();
+    secretionRatesOutdated = true;
 }
 
 void ParticleManager::includeParticleXMLTagToc(XMLFile *xmlTags) {
     std::ostringstream ssid;
     XMLNode particlesNode = xmlTags->addChildToRootNode("Particles");
-    auto itP = allParticles.begin();
-
-    // output of particles and their neighbour-connections
-    while (itP != allParticles.end()) {
-        auto p = *itP;
+    // output of the active particles and their neighbour-connections, in the order and with the ids of the input
+    const auto &inputIds = particles.topology->getInputIds();
+    for (const auto inputId: activeInputIds) {
+        auto p = getParticleByInputId(inputId);
         XMLNode particleNode = xmlTags->addChildToNode(particlesNode, "Particle");
         std::ostringstream sId, sConc, sArea, sInSite, sBoundary;
-        sId << p->getId();
-        Coordinate3D pos = p->getPosition();
-        sConc << p->getConcentration();
-        sArea << p->getArea();
-        sInSite << p->getIsInSite();
-        sBoundary << p->getIsAtBoundary();
+        sId << inputId;
+        Coordinate3D pos = p.getPosition();
+        sConc << p.getConcentration();
+        sArea << p.getArea();
+        sInSite << p.getIsInSite();
+        sBoundary << p.getIsAtBoundary();
         xmlTags->addDataFieldToNode(particleNode, "id", "discrete", "unsigned int", sId.str());
         xmlTags->addDataFieldToNode(particleNode, "inSite", "discrete", "unsigned int", sInSite.str());
         xmlTags->addDataFieldToNode(particleNode, "atBoundary", "discrete", "unsigned int", sBoundary.str());
@@ -302,36 +438,40 @@ void ParticleManager::includeParticleXMLTagToc(XMLFile *xmlTags) {
         xmlTags->addDataFieldToNode(particleNode, "area", "continuous", "double", sArea.str());
         //neighbours
         XMLNode interactionPartnersNode = xmlTags->addChildToNode(particleNode, "Interactions");
-        std::vector<Particle *> neighbourList = p->getParticleNeighbourList()->getNeighbours();
-        std::vector<double> contactArea = p->getParticleNeighbourList()->getContactAreas();
+        const auto neighbourList = p.getParticleNeighbourList().getNeighbourIds();
+        const auto contactArea = p.getParticleNeighbourList().getContactAreas();
         size_t i = 0;
         while (i < neighbourList.size()) {
+            // neighbours of boundary particles may be outside of the output
+            if (!particles.inSite[neighbourList[i]] && !particles.atBoundary[neighbourList[i]]) {
+                i++;
+                continue;
+            }
             std::ostringstream sIdN, sContactN;
-            sIdN << neighbourList[i]->getId();
+            sIdN << inputIds[neighbourList[i]];
             sContactN << contactArea[i];
             XMLNode interactionPartner = xmlTags->addChildToNode(interactionPartnersNode, "Particle");
             xmlTags->addDataFieldToNode(interactionPartner, "id", "discrete", "unsigned int", sIdN.str());
             xmlTags->addDataFieldToNode(interactionPartner, "contact", "continuous", "double", sContactN.str());
             i++;
         }
-        itP++;
     }
 
-    //output of isolines
+    //output of isolines (the triangles may also exist for the point location of getGradient)
+    if (!drawIsolines) return;
     const int nIsolines = 5;
     double isolinesConc[nIsolines] = {24.0, 12.0, 6.0, 3, 1.5};
 
-    auto itT = triangles.begin();
-    while (itT != triangles.end()) {
-        TRIANGLE3D t3d = *itT;
-        auto p1 = allParticles[t3d.neighbourIds[0]];
-        auto p2 = allParticles[t3d.neighbourIds[1]];
-        auto p3 = allParticles[t3d.neighbourIds[2]];
-
-        double c1, c2, c3;
-        c1 = p1->getConcentration();
-        c2 = p2->getConcentration();
-        c3 = p3->getConcentration();
+    // vertices and concentrations are read from the indexed arrays of the mesh and the store
+    const auto &positions = particles.topology->getPositions();
+    const auto &concentrations = particles.concentrations;
+    for (const auto &t3d: triangles) {
+        const Coordinate3D &pos1 = positions[t3d.neighbourIds[0]];
+        const Coordinate3D &pos2 = positions[t3d.neighbourIds[1]];
+        const Coordinate3D &pos3 = positions[t3d.neighbourIds[2]];
+        const double c1 = concentrations[t3d.neighbourIds[0]];
+        const double c2 = concentrations[t3d.neighbourIds[1]];
+        const double c3 = concentrations[t3d.neighbourIds[2]];
 
         double minConc = std::min(std::min(c1, c2), c3);
         double maxConc = std::max(std::max(c1, c2), c3);
@@ -347,29 +487,29 @@ void ParticleManager::includeParticleXMLTagToc(XMLFile *xmlTags) {
                 double relDist31 = (isolinesConc[i] - c3) / (c1 - c3);
 
                 if (relDist12 < 1 && relDist12 > 0) {
-                    Coordinate3D connect(p2->getPosition() - p1->getPosition());
+                    Coordinate3D connect(pos2 - pos1);
                     connect *= relDist12;
-                    pointIso1 = p1->getPosition();
+                    pointIso1 = pos1;
                     pointIso1 += connect;
                 }
 
                 if (relDist23 < 1 && relDist23 > 0) {
-                    Coordinate3D connect(p3->getPosition() - p2->getPosition());
+                    Coordinate3D connect(pos3 - pos2);
                     connect *= relDist23;
 
                     if (pointIso1.x == 0 && pointIso1.y == 0 && pointIso1.z == 0) {
-                        pointIso1 = p2->getPosition();
+                        pointIso1 = pos2;
                         pointIso1 += connect;
                     } else {
-                        pointIso2 = p2->getPosition();
+                        pointIso2 = pos2;
                         pointIso2 += connect;
                     }
                 }
 
                 if (relDist31 < 1 && relDist31 > 0) {
-                    Coordinate3D connect(p1->getPosition() - p3->getPosition());
+                    Coordinate3D connect(pos1 - pos3);
                     connect *= relDist31;
-                    pointIso2 = p3->getPosition();
+                    pointIso2 = pos3;
                     pointIso2 += connect;
                 }
             }
@@ -387,26 +527,228 @@ void ParticleManager::includeParticleXMLTagToc(XMLFile *xmlTags) {
             pointIso1 = Coordinate3D();
             pointIso2 = Coordinate3D();
         }
-        itT++;
     }
 }
 
-void ParticleManager::diffusionPSE(double timestep, double time_delta) {
-    for (auto itP = allParticles.begin(); itP != allParticles.end(); itP++) {
-        (*itP)->diffusePSE(timestep);
+void ParticleManager::diffusionPSE(double timestep) {
+    if (diffusionBackend == DiffusionBackend::CSR && particles.numberOfAdditionalSpecies > 0) {
+        // all species share the traversal of the neighbour rows
+        diffusionMatrix.multiplySpecies(particles.concentrations, particles.concentrationChanges,
+                                        particles.speciesConcentrations, particles.speciesConcentrationChanges,
+                                        speciesDCRatios, timestep);
+    } else if (diffusionBackend == DiffusionBackend::CSR) {
+        diffusionMatrix.multiply(particles.concentrations, particles.concentrationChanges, timestep);
+    } else {
+        const auto &rows = particles.inSiteIds;
+        const auto numberOfRows = static_cast<int>(rows.size());
+        // each particle only adds to its own concentration change
+#pragma omp parallel for num_threads(diffusionThreads) schedule(static) if(diffusionThreads > 1)
+        for (int i = 0; i < numberOfRows; i++) {
+            // Do all actions for one timestep for each particle
+            getParticle(rows[i]).doAllActionsForTimestep(timestep);
+        }
     }
-    double maxChange = 0, change;
-    for (auto itP = allParticles.begin(); itP != allParticles.end(); itP++) {
-        change = (*itP)->applyConcentrationChange(time_delta);
-        if (change > maxChange) {
-            maxChange = change;
+}
+
+double ParticleManager::applyConcentrationChanges(double time_delta) {
+    double maxChange = 0;
+    if (diffusionBackend == DiffusionBackend::CSR) {
+        maxChange = diffusionMatrix.apply(particles.concentrations, particles.concentrationChanges, time_delta);
+        if (particles.numberOfAdditionalSpecies > 0) {
+            diffusionMatrix.applySpecies(particles.speciesConcentrations, particles.speciesConcentrationChanges,
+                                         particles.numberOfAdditionalSpecies);
+        }
+    } else {
+        const auto &rows = particles.inSiteIds;
+        const auto numberOfRows = static_cast<int>(rows.size());
+#pragma omp parallel for num_threads(diffusionThreads) schedule(static) reduction(max:maxChange) if(diffusionThreads > 1)
+        for (int i = 0; i < numberOfRows; i++) {
+            const double change = getParticle(rows[i]).applyConcentrationChange(time_delta);
+            if (change > maxChange) {
+                maxChange = change;
+            }
         }
     }
+    return maxChange;
+}
+
+double ParticleManager::updateConcentrations(double timestep) {
+    // every path below changes the concentrations, the cached gradients are evaluated again on the next query
+    particles.gradientsOutdated = true;
+    slopesOutdated = true;
+    if (steadyStateLibrary.isActive() && loadSteadyStateField(timestep)) {
+        return 0;
+    }
+    if (steadyStateDetection == SteadyStateDetection::RESIDUAL_L2) {
+        // only the "in site" rows enter the residual, in the order of inSiteIds
+        previousConcentrations.resize(particles.inSiteIds.size());
+        for (size_t k = 0; k < particles.inSiteIds.size(); k++) {
+            previousConcentrations[k] = particles.concentrations[particles.inSiteIds[k]];
+        }
+    }
+    const double maxChange = concentrationStep(timestep);
+    if (steadyStateDetection == SteadyStateDetection::RESIDUAL_MAX) {
+        recordResidual(maxChange);
+    } else if (steadyStateDetection == SteadyStateDetection::RESIDUAL_L2) {
+        // relative change of the field in the site per time unit, like the maximal change of a single particle
+        double difference = 0, norm = 0;
+        for (size_t k = 0; k < particles.inSiteIds.size(); k++) {
+            const double change = particles.concentrations[particles.inSiteIds[k]] - previousConcentrations[k];
+            difference += change * change;
+            norm += previousConcentrations[k] * previousConcentrations[k];
+        }
+        recordResidual(norm > 0 ? std::sqrt(difference / norm) / timestep : 0.0);
+    }
+    return maxChange;
+}
+
+unsigned int ParticleManager::countOutOfSiteParticles(const Coordinate3D &position, double reach) const {
+    unsigned int count = 0;
+    for (const auto &outOfSitePosition: outOfSitePositions) {
+        if (position.calculateEuclidianDistance(outOfSitePosition) < reach) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void ParticleManager::addUptake(const std::vector<std::pair<unsigned int, double>> &uptake) {
+    for (const auto &[id, change]: uptake) {
+        particles.concentrationChanges[id] += change;
+        // the change is applied in this timestep, not when the front reaches the particle
+        if (activeSetDiffusion && change != 0) {
+            activeSet.activate(id);
+        }
+    }
+}
+
+void ParticleManager::recordResidual(double residual) {
+    // a new or removed conidium changes the secretion, the field has to converge again
+    const double lastConidiaChange = site->getAgentManager()->getLastConidiaChange();
+    if (lastConidiaChange != residualConidiaChange) {
+        residualConidiaChange = lastConidiaChange;
+        stepsBelowTolerance = 0;
+    }
+    if (residual < steadyStateTolerance) {
+        stepsBelowTolerance++;
+    } else {
+        stepsBelowTolerance = 0;
+    }
+}
+
+double ParticleManager::concentrationStep(double timestep) {
+    if (implicitDiffusion) {
+        // secretion and uptake enter the right hand side of the linear system
+        inputOfParticles(timestep);
+        return implicitSolver.solve(particles.concentrations, particles.concentrationChanges, timestep, timestep);
+    }
+    if (activeSetDiffusion) {
+        // only the particles at and behind the front exchange concentration, for every backend
+        diffusionMatrix.multiplyRows(activeSet.getRows(), particles.concentrations, particles.concentrationChanges, timestep);
+        inputOfParticles(timestep);
+        for (const auto &particle: aecParticles) {
+            activeSet.activate(particle.getId());
+        }
+        const double maxChange = diffusionMatrix.applyRows(activeSet.getRows(), particles.concentrations, particles.concentrationChanges,
+                                                           timestep);
+        activeSet.propagate(particles.concentrations);
+        return maxChange;
+    }
+    if (diffusionBackend == DiffusionBackend::SIMD) {
+        inputOfParticles(timestep);
+        const double maxChange = diffusionMatrix.step(particles.concentrations, nextConcentrations, particles.concentrationChanges,
+                                                      secretionRates, timestep, timestep);
+        // swapping keeps the vector objects (and thereby the particle handles) valid
+        particles.concentrations.swap(nextConcentrations);
+        return maxChange;
+    }
+    // Exchange concentrations between all particles
+    diffusionPSE(timestep);
+    // Initialize Particles
+    inputOfParticles(timestep);
+    // Apply actual concentration change to particles
+    return applyConcentrationChanges(timestep);
+}
+
+bool ParticleManager::loadSteadyStateField(double time_delta) {
+    cleanUpChemotaxis();
+    if (!aecParticles.empty() || particleSecretionMoleculePerCellMin <= 0) {
+        return false;
+    }
+    collectAECParticles(site, time_delta);
+    if (aecParticles.empty()) {
+        return false;
+    }
+
+    // the steady state is linear in the sources: the field is the sum of the fields of all secreting AECs
+    const auto numberOfParticles = particles.concentrations.size();
+    std::fill(particles.concentrations.begin(), particles.concentrations.end(), 0.0);
+    for (const auto cell: aecCells) {
+        std::vector<unsigned int> secretingIds;
+        for (size_t i = 0; i < aecParticles.size(); i++) {
+            if (aecParticlesCells[i] == cell) {
+                secretingIds.push_back(aecParticles[i].getId());
+            }
+        }
+        if (secretingIds.empty()) {
+            continue;
+        }
+        std::sort(secretingIds.begin(), secretingIds.end());
+        std::ostringstream key;
+        if (numberOfGeneratedParticles > 0) {
+            key << "sphere" << numberOfGeneratedParticles << "_r" << site->getRadius();
+        } else {
+            key << boost::filesystem::path(particleInputDelauneyFile).stem().string();
+        }
+        // the field is stored by particle id and depends on the ordering of the particles
+        if (particles.topology->getOrdering() != ParticleOrdering::NONE) {
+            key << "_o" << static_cast<int>(particles.topology->getOrdering());
+        }
+        const auto numberOfTypeOne = static_cast<int>(alvEpithTypeOne.size());
+        if (cell < numberOfTypeOne) {
+            key << "_aec1-" << cell;
+        } else {
+            key << "_aec2-" << cell - numberOfTypeOne;
+        }
+        key << "_dc" << dc << "_s" << particleSecretionMoleculePerCellMin << "_" << std::hex << fnv1aDigest(secretingIds);
+
+        const double secretionPerMinute = particleSecretionMoleculePerCellMin / sumAreaAEcParticlesCells[cell];
+        const double *field = steadyStateLibrary.getField(key.str(), numberOfParticles, [&](std::vector<double> &f) {
+            std::vector<double> sources(numberOfParticles, 0.0);
+            for (const auto id: secretingIds) {
+                sources[id] = secretionPerMinute;
+            }
+            implicitSolver.solveSteadyState(sources, f);
+        });
+        for (size_t i = 0; i < numberOfParticles; i++) {
+            particles.concentrations[i] += field[i];
+        }
+    }
+    // the loaded field already balances secretion and exchange, changes of the previous field are obsolete
+    std::fill(particles.concentrationChanges.begin(), particles.concentrationChanges.end(), 0.0);
+    diffusionMatrix.synchronize(particles.concentrations);
+    if (activeSetDiffusion) {
+        activeSet.activateAll();
+    }
+    libraryConidiaChange = site->getAgentManager()->getLastConidiaChange();
+    return true;
 }
 
 bool ParticleManager::steadyStateReached(double current_time) {
+    // the slower additional species are not in a steady state with the chemokine, they diffuse in every timestep
+    if (!speciesDCRatios.empty()) {
+        return false;
+    }
     bool stStReached = false;
-    if (dc > 500) { //below 500, reaching a steady state takes too much time
+    if (steadyStateLibrary.isActive() && libraryConidiaChange == site->getAgentManager()->getLastConidiaChange()) {
+        stStReached = true;
+        allowHigherDT = stStReached;
+    } else if (steadyStateDetection != SteadyStateDetection::LOOKUP) {
+        // the diffusion is switched off until the next conidia change, no residuals are recorded meanwhile
+        stStReached = stepsBelowTolerance >= steadyStateWindow &&
+                      site->getAgentManager()->getLastConidiaChange() == residualConidiaChange;
+        allowHigherDT = stStReached;
+    } else if (dc > 500) { //below 500, reaching a steady state takes too much time
         // all values below were found experimentally
         if (dc == 600) {
             stStReached =
@@ -438,110 +780,198 @@ bool ParticleManager::steadyStateReached(double current_time) {
 }
 
 double ParticleManager::getGradient(const Coordinate3D &position) {
-    double gradient{};
-    std::vector<unsigned int> closest3ParticleIdxs;
-    this->getParticleBalloonList()->getClosestObjectIndices(position, closest3ParticleIdxs, 3);
-    auto p1 = allParticles[closest3ParticleIdxs[0]];
-    auto p2 = allParticles[closest3ParticleIdxs[1]];
-    auto p3 = allParticles[closest3ParticleIdxs[2]];
-    double linearlyInterpolatedValue = Algorithms::interpolateBilinearOnTriangle(position, p1->getPosition(),
-                                                                                 p1->getGradientStrength(),
-                                                                                 p2->getPosition(),
-                                                                                 p2->getGradientStrength(),
-                                                                                 p3->getPosition(),
-                                                                                 p3->getGradientStrength());
-    gradient = linearlyInterpolatedValue;
-    return gradient;
+    int triangleHint = -1;
+    return getGradient(position, triangleHint);
 }
 
-void ParticleManager::extractTriangles() {
-    auto itP = allParticles.begin();
-    while (itP != allParticles.end()) {
-        auto p = *itP;
-        int idP = p->getId();
-        size_t i = 0, j = 0;
-        std::vector<Particle *> neighbourList = p->getParticleNeighbourList()->getNeighbours();
-        while (i < neighbourList.size()) {
-            j = i + 1;
-            int idI = neighbourList[i]->getId();;
-            //check if neighbours (i,j) are neighbours of each other
-            while (j < neighbourList.size()) {
-                int idJ = neighbourList[j]->getId();
-                if (allParticles[idI]->getParticleNeighbourList()->existsInList(neighbourList[j])) {
-                    addTriangle(idP, idI, idJ);
-                }
-                j++;
-            }
-            i++;
-        }
-        itP++;
+std::array<unsigned int, 3> ParticleManager::locateTriangle(const Coordinate3D &position, int &triangleHint) {
+    if (triangleLocator.isEmpty()) {
+        if (triangles.empty()) extractTriangles();
+        triangleLocator.build(triangles, particles.topology->getPositions());
     }
+    // the walk starts at the last triangle of the caller, a cold start begins at a triangle of the closest particle
+    int triangle = triangleLocator.locate(position, triangleHint);
+    if (triangle < 0) {
+        const auto closestParticle = particleBalloonList->getClosestObjectIndex(position);
+        triangle = triangleLocator.locate(position, triangleLocator.getTriangleOfVertex(closestParticle));
+    }
+    triangleHint = triangle;
+
+    std::array<unsigned int, 3> closest3ParticleIdxs{};
+    if (triangle >= 0) {
+        const auto &ids = triangleLocator.getTriangle(triangle).neighbourIds;
+        std::copy(ids, ids + 3, closest3ParticleIdxs.begin());
+    } else {
+        // outside of the triangulated part of the mesh the three closest particles are interpolated
+        std::vector<unsigned int> closestParticles;
+        particleBalloonList->getClosestObjectIndices(position, closestParticles, 3);
+        std::copy(closestParticles.begin(), closestParticles.begin() + 3, closest3ParticleIdxs.begin());
+    }
+    return closest3ParticleIdxs;
 }
 
-void ParticleManager::addTriangle(unsigned int id1, unsigned int id2, unsigned int id3) {
-    std::vector<unsigned int> sorted;
-    sorted.push_back(id1);
-    sorted.push_back(id2);
-    sorted.push_back(id3);
-    std::sort(sorted.begin(), sorted.end());
-    bool toBeAdded = true;
+double ParticleManager::getGradient(const Coordinate3D &position, int &triangleHint) {
+    const auto ids = locateTriangle(position, triangleHint);
+    auto p1 = getParticle(ids[0]);
+    auto p2 = getParticle(ids[1]);
+    auto p3 = getParticle(ids[2]);
+    if (meshInterpolation == MeshInterpolation::QUADRATIC) {
+        updateSlopes();
+        // the quadratic may overshoot between the vertices, a gradient strength is never negative
+        return std::max(0.0, Algorithms::interpolateBiquadraticOnTriangle(
+                position, p1.getPosition(), p1.getGradientStrength(), gradientStrengthSlopes[ids[0]],
+                p2.getPosition(), p2.getGradientStrength(), gradientStrengthSlopes[ids[1]],
+                p3.getPosition(), p3.getGradientStrength(), gradientStrengthSlopes[ids[2]]));
+    }
+    double linearlyInterpolatedValue = Algorithms::interpolateBilinearOnTriangle(position, p1.getPosition(),
+                                                                                 p1.getGradientStrength(),
+                                                                                 p2.getPosition(),
+                                                                                 p2.getGradientStrength(),
+                                                                                 p3.getPosition(),
+                                                                                 p3.getGradientStrength());
+    return linearlyInterpolatedValue;
+}
 
-    //check if this triangle is already in the list of triangles
-    auto itT = triangles.begin();
-    while (itT != triangles.end()) {
-        TRIANGLE3D t3d = *itT;
-        if (t3d.neighbourIds[0] == sorted[0]) {
-            if (t3d.neighbourIds[1] == sorted[1]) {
-                if (t3d.neighbourIds[2] == sorted[2]) {
-                    toBeAdded = false;
-                }
-            }
+double ParticleManager::getConcentration(const Coordinate3D &position, int &triangleHint) {
+    const auto ids = locateTriangle(position, triangleHint);
+    const auto &positions = particles.topology->getPositions();
+    const auto &c = particles.concentrations;
+    if (meshInterpolation == MeshInterpolation::QUADRATIC) {
+        updateSlopes();
+        return std::max(0.0, Algorithms::interpolateBiquadraticOnTriangle(
+                position, positions[ids[0]], c[ids[0]], concentrationSlopes[ids[0]],
+                positions[ids[1]], c[ids[1]], concentrationSlopes[ids[1]],
+                positions[ids[2]], c[ids[2]], concentrationSlopes[ids[2]]));
+    }
+    const auto l = Algorithms::barycentricCoordinates(position, positions[ids[0]], positions[ids[1]], positions[ids[2]]);
+    return l[0] * c[ids[0]] + l[1] * c[ids[1]] + l[2] * c[ids[2]];
+}
+
+Coordinate3D ParticleManager::getGradientVector(const Coordinate3D &position, int &triangleHint) {
+    const auto ids = locateTriangle(position, triangleHint);
+    const auto &positions = particles.topology->getPositions();
+    std::array<Coordinate3D, 3> gradients{};
+    for (int i = 0; i < 3; i++) {
+        gradients[i] = getParticle(ids[i]).getGradient();
+    }
+    if (meshInterpolation == MeshInterpolation::QUADRATIC) {
+        updateSlopes();
+        // every component is a field of its own, its slopes are the slopes of the gradients (second ring)
+        std::array<double, 3> components{};
+        for (int a = 0; a < 3; a++) {
+            const auto component = [&](int i) { return a == 0 ? gradients[i].x : a == 1 ? gradients[i].y : gradients[i].z; };
+            components[a] = Algorithms::interpolateBiquadraticOnTriangle(
+                    position, positions[ids[0]], component(0), gradientSlopes[ids[0]][a],
+                    positions[ids[1]], component(1), gradientSlopes[ids[1]][a],
+                    positions[ids[2]], component(2), gradientSlopes[ids[2]][a]);
         }
+        return {components[0], components[1], components[2]};
+    }
+    const auto l = Algorithms::barycentricCoordinates(position, positions[ids[0]], positions[ids[1]], positions[ids[2]]);
+    return gradients[0] * l[0] + gradients[1] * l[1] + gradients[2] * l[2];
+}
 
-        itT++;
+void ParticleManager::computeSlopeWeights() {
+    const auto &topology = *particles.topology;
+    const auto &positions = topology.getPositions();
+    const auto &offsets = topology.getNeighbourOffsets();
+    const auto &ids = topology.getNeighbourIds();
+    const auto center = site->getCenterPosition();
+    slopeWeights.assign(ids.size(), Coordinate3D());
+    for (unsigned int i = 0; i < topology.getNumberOfParticles(); i++) {
+        // tangent basis of the sphere at the particle
+        auto normal = positions[i] - center;
+        normal.setMagnitude(1.0);
+        auto t1 = (std::abs(normal.x) < 0.5 ? Coordinate3D{1, 0, 0} : Coordinate3D{0, 1, 0}).crossProduct(normal);
+        t1.setMagnitude(1.0);
+        const auto t2 = normal.crossProduct(t1);
+
+        // normal equations of the plane through the particle that fits the neighbours best
+        double m11 = 0, m12 = 0, m22 = 0;
+        for (auto k = offsets[i]; k < offsets[i + 1]; k++) {
+            const auto d = positions[ids[k]] - positions[i];
+            const double x = d.scalarProduct(t1), y = d.scalarProduct(t2);
+            m11 += x * x;
+            m12 += x * y;
+            m22 += y * y;
+        }
+        const double determinant = m11 * m22 - m12 * m12;
+        if (determinant <= 1e-12 * (m11 + m22) * (m11 + m22)) {
+            continue;
+        }
+        for (auto k = offsets[i]; k < offsets[i + 1]; k++) {
+            const auto d = positions[ids[k]] - positions[i];
+            const double x = d.scalarProduct(t1), y = d.scalarProduct(t2);
+            slopeWeights[k] = t1 * ((m22 * x - m12 * y) / determinant) + t2 * ((m11 * y - m12 * x) / determinant);
+        }
     }
+}
 
-    if (toBeAdded) {
-        TRIANGLE3D newTriangle{};
-        newTriangle.outside = TRUE;
-        newTriangle.neighbourIds[0] = sorted[0];
-        newTriangle.neighbourIds[1] = sorted[1];
-        newTriangle.neighbourIds[2] = sorted[2];
-        if (allParticles[newTriangle.neighbourIds[0]]->getIsInSite()) {
-            newTriangle.outside = FALSE;
-        } else {
-            if (allParticles[newTriangle.neighbourIds[1]]->getIsInSite()) {
-                newTriangle.outside = FALSE;
-            } else {
-                if (allParticles[newTriangle.neighbourIds[2]]->getIsInSite()) {
-                    newTriangle.outside = FALSE;
-                }
-            }
+void ParticleManager::updateSlopes() {
+    if (!slopesOutdated) {
+        return;
+    }
+    if (slopeWeights.empty()) {
+        computeSlopeWeights();
+    }
+    if (particles.gradientsOutdated) {
+        particles.topology->evaluateGradients(particles.concentrations, particles.inSiteIds, particles.gradients);
+        particles.gradientsOutdated = false;
+    }
+    const auto numberOfParticles = getNumberOfParticles();
+    const auto &offsets = particles.topology->getNeighbourOffsets();
+    const auto &ids = particles.topology->getNeighbourIds();
+    const auto &c = particles.concentrations;
+    const auto &g = particles.gradients;
+    concentrationSlopes.assign(numberOfParticles, Coordinate3D());
+    gradientStrengthSlopes.assign(numberOfParticles, Coordinate3D());
+    gradientSlopes.assign(numberOfParticles, {});
+    // "out of site" particles have no gradient, their data is interpolated linearly
+    for (const auto i: particles.inSiteIds) {
+        const double strength = g[i].getMagnitude();
+        for (auto k = offsets[i]; k < offsets[i + 1]; k++) {
+            const auto j = ids[k];
+            const auto &w = slopeWeights[k];
+            concentrationSlopes[i] += w * (c[j] - c[i]);
+            gradientStrengthSlopes[i] += w * (g[j].getMagnitude() - strength);
+            gradientSlopes[i][0] += w * (g[j].x - g[i].x);
+            gradientSlopes[i][1] += w * (g[j].y - g[i].y);
+            gradientSlopes[i][2] += w * (g[j].z - g[i].z);
         }
+    }
+    slopesOutdated = false;
+}
+
+void ParticleManager::extractTriangles() {
+    // the triangles of the mesh are shared by all runs, only the "outside" label depends on the site
+    const auto &meshTriangles = particles.topology->getTriangles();
+    triangles.clear();
+    triangles.reserve(meshTriangles.size());
+    for (const auto &vertices: meshTriangles) {
+        TRIANGLE3D newTriangle{};
+        newTriangle.outside = !particles.inSite[vertices[0]] && !particles.inSite[vertices[1]] &&
+                              !particles.inSite[vertices[2]];
+        std::copy(vertices.begin(), vertices.end(), newTriangle.neighbourIds);
         triangles.push_back(newTriangle);
     }
 }
 
 double ParticleManager::getSumChemokine() {
-    auto itP = allParticles.begin();
     double sumOfChemokine = 0.0;
-    int counter = 0;
-    while (itP != allParticles.end()) {
-        auto p = *itP;
-        double conc_p = p->getConcentration();
-        sumOfChemokine += conc_p;
-        itP++;
+    for (const auto id: particles.inSiteIds) {
+        sumOfChemokine += particles.concentrations[id];
     }
     return sumOfChemokine;
 }
 
 int ParticleManager::get_closest_AEC_ID(Coordinate3D position, int type) {    //position of particle and cell type
 
+    const SphericCoordinate3D sphericPosition = abm::util::toSphericCoordinates(position);
     if (type == 1) {
         int id = -1;
         double mindist = 1000000;
         for (size_t i = 0; i < alvEpithTypeOne.size(); i++) {
-            double dist = alvEpithTypeOne.at(i).calculateEuclidianDistance(abm::util::toSphericCoordinates(position));
+            double dist = alvEpithTypeOne.at(i).calculateEuclidianDistance(sphericPosition);
             if (dist < mindist) {
                 mindist = dist;
                 id = i;
@@ -553,7 +983,7 @@ int ParticleManager::get_closest_AEC_ID(Coordinate3D position, int type) {    //
         int id = -1;
         double mindist = 1000000;
         for (size_t i = 0; i < alvEpithTypeTwo.size(); i++) {
-            double dist = alvEpithTypeTwo.at(i).calculateEuclidianDistance(abm::util::toSphericCoordinates(position));
+            double dist = alvEpithTypeTwo.at(i).calculateEuclidianDistance(sphericPosition);
             if (dist < mindist) {
                 mindist = dist;
                 id = i;
@@ -567,6 +997,8 @@ int ParticleManager::get_closest_AEC_ID(Coordinate3D position, int type) {    //
 void ParticleManager::setAECCells(std::vector<SphericCoordinate3D> AECT1, std::vector<SphericCoordinate3D> AECT2) {
     alvEpithTypeOne = AECT1;
     alvEpithTypeTwo = AECT2;
+    sumAreaAEcParticlesCells.assign(alvEpithTypeOne.size() + alvEpithTypeTwo.size(), 0);
+    aecSecretionratePerGrid.assign(alvEpithTypeOne.size() + alvEpithTypeTwo.size(), 0);
     DEBUG_STDOUT("particle Manager got information about " << std::to_string(alvEpithTypeOne.size()) << " AECT1 cells");
     DEBUG_STDOUT("particle Manager got information about " << std::to_string(alvEpithTypeTwo.size()) << " AECT2 cells");
 }
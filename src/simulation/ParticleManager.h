@@ -11,42 +11,71 @@
 #ifndef PARTICLEMANAGER_H
 #define PARTICLEMANAGER_H
 
+#include <array>
 #include <memory>
+#include <optional>
+#include <set>
+#include <utility>
 #include <vector>
 
-#include <boost/numeric/ublas/io.hpp>
-#include <boost/numeric/ublas/lu.hpp>
-#include <boost/numeric/ublas/matrix.hpp>
-#include <boost/numeric/ublas/matrix_sparse.hpp>
-#include <boost/numeric/ublas/vector.hpp>
-
 #include "io/XMLFile.h"
 #include "simulation/Particle.h"
+#include "simulation/ParticleStore.h"
+#include "simulation/ParticleTopology.h"
+#include "simulation/diffusion/ActiveSet.h"
+#include "simulation/diffusion/DiffusionMatrix.h"
+#include "simulation/diffusion/ImplicitDiffusionSolver.h"
+#include "simulation/diffusion/SteadyStateLibrary.h"
 #include "simulation/neighbourhood/StaticBalloonList.h"
+#include "simulation/neighbourhood/TriangleLocator.h"
 #include "utils/io_util.h"
 
-struct TRIANGLE3D {
-    bool outside;
-    unsigned int neighbourIds[3];
+class Site;
+
+enum class DiffusionBackend {
+    PARTICLE, // every particle exchanges concentration with its neighbour list (Particle::diffusePSE)
+    CSR, // one sparse matrix-vector product over the contiguous concentration array (DiffusionMatrix)
+    SIMD // fused secretion, exchange and application in one vectorized pass (DiffusionMatrix::step)
 };
 
-using namespace boost::numeric;
+enum class SteadyStateDetection {
+    LOOKUP, // experimentally found times after the last conidia change per dc
+    RESIDUAL_MAX, // maximal relative change of a particle stays below the tolerance over a window of steps
+    RESIDUAL_L2 // relative L2 change of the field stays below the tolerance over a window of steps
+};
+
+enum class MeshInterpolation {
+    NONE, // agents use the data of the particles in their reach, position queries are interpolated linearly
+    LINEAR, // agents query the triangle at their position, barycentric interpolation of the vertex data
+    QUADRATIC // agents query the triangle at their position, P2 interpolation from the vertex data and its slopes
+};
 
 class ParticleManager {
 public:
     /// Class for managing diffusion of particles inside the site
     explicit ParticleManager(Site *site);
-    std::vector<std::shared_ptr<Particle>> &getAllParticles() { return allParticles; };
+    /// Returns the handle of a particle, valid as long as the particle manager exists
+    Particle getParticle(unsigned int id) { return Particle(&particles, id); };
+    /// Returns the handle of the particle with the given id of the input (the particles may be reordered)
+    Particle getParticleByInputId(unsigned int inputId) {
+        return Particle(&particles, particles.topology->getIdsOfInputIds()[inputId]);
+    };
+    [[nodiscard]] size_t getNumberOfParticles() const { return particles.concentrations.size(); };
+    /// Returns the number of molecule species: the chemokine and the additional species
+    [[nodiscard]] unsigned int getNumberOfSpecies() const { return 1 + particles.numberOfAdditionalSpecies; };
+    [[nodiscard]] const ParticleTopology *getTopology() const { return particles.topology.get(); };
 
     /*!
      * Initializes particles (i.e. takes particles from fixed input file)
      * @param site Site object of environment (e.g. AlveoleSite)
      * @param parameters Parameter object that contains parameters of particle manager
      * @param input_dir String that contains input directory
+     * @param particleTopology ParticleTopology object that is shared by all runs (loaded here if it is empty)
      */
     void initializeParticles(Site *site,
                              const abm::util::SimulationParameters::ParticleManagerParameters &parameters,
-                             const std::string &input_dir);
+                             const std::string &input_dir,
+                             std::shared_ptr<const ParticleTopology> particleTopology = nullptr);
 
     /*!
      * Input of particles
@@ -54,69 +83,174 @@ public:
      */
     void inputOfParticles(double time_delta);
 
+    /// Inits clean up of all particles
+    void cleanUpAllParticles();
+    void computeMinTimestepDistribution();
+
     /*!
-     * Creates a particle
-     * @param site Site object of environment (e.g. AlveoleSite)
-     * @param pos Coordinate3D object for position of particle
-     * @param conc Double that contains initial concentration
-     * @param dc Double that contains the diffusion coefficient
-     * @return Particle object
+     * Calculates the PSE concentration exchange between all particles for one timestep
+     * @param timestep Double that contains timestep
      */
-    std::shared_ptr<Particle> createParticle(Site *site, Coordinate3D pos, double conc, double dc);
+    void diffusionPSE(double timestep);
 
     /*!
-     * Replaces or removes a particle (i.e. for absorbing boundaries)
-     * @param site
-     * @param particle
-     * @param newParticle
+     * Applies the accumulated concentration changes (PSE, secretion and uptake) of all particles
+     * @param time_delta Double that contains timestep
+     * @return Double that contains the maximal relative concentration change
      */
-    void replaceParticle(Site *site, Particle *particle, std::shared_ptr<Particle> newParticle);
+    double applyConcentrationChanges(double time_delta);
 
-    /// Inits clean up of all particles
-    void cleanUpAllParticles();
-    void computeMinTimestepDistribution();
-    void diffusionPSE(double timestep, double time_delta);
+    /*!
+     * Performs one diffusion timestep: PSE exchange, secretion of AECs and application of all changes
+     * With an implicit solver the PSE exchange is solved for the end of the timestep, otherwise the backend is used
+     * @param timestep Double that contains timestep
+     * @return Double that contains the maximal relative concentration change
+     */
+    double updateConcentrations(double timestep);
+
+    /*!
+     * Adds the uptake of one agent to the concentration changes of the particles
+     * @param uptake vector of (particle id, concentration change) pairs collected by an agent
+     */
+    void addUptake(const std::vector<std::pair<unsigned int, double>> &uptake);
     void includeParticleXMLTagToc(XMLFile *xmlTags);
     void setCleanChemotaxis(bool val) { clean_chemotaxis = val; };
     void setAECCells(std::vector<SphericCoordinate3D> AECT1, std::vector<SphericCoordinate3D> AECT2);
 
-    std::shared_ptr<Particle> getParticleByPosition(Coordinate3D pos);
+    /*!
+     * Adds a particle to the secreting particles of an AEC, a particle secretes for the first AEC it is added to
+     * @param id unsigned int that contains the id of the particle
+     * @param type int that contains the type of the AEC (1 or 2)
+     * @param aecId int that contains the index of the AEC within its type
+     */
+    void addAECParticle(unsigned int id, int type, int aecId);
+
+    /*!
+     * Distributes the secretion of each AEC over the area of its secreting particles
+     * @param time_delta Double that contains timestep
+     */
+    void computeAECSecretionRates(double time_delta);
+    [[nodiscard]] double getAECArea(int type, int aecId) const { return sumAreaAEcParticlesCells[aecIndex(type, aecId)]; };
+    [[nodiscard]] double getAECSecretionRate(int type, int aecId) const {
+        return aecSecretionratePerGrid[aecIndex(type, aecId)];
+    };
+
+    std::optional<Particle> getParticleByPosition(Coordinate3D pos);
     StaticBalloonList *getParticleBalloonList() { return particleBalloonList.get(); }
+
+    /*!
+     * Counts the "out of site" particles in reach of a position that also has an "in site" or boundary particle in reach
+     * @param position Coordinate3D object that contains the position of the agent
+     * @param reach Double that contains the distance below which a particle is in reach (at most the grid constant)
+     * @return unsigned int that contains the number of "out of site" particles in reach
+     */
+    [[nodiscard]] unsigned int countOutOfSiteParticles(const Coordinate3D &position, double reach) const;
     double getGradient(const Coordinate3D &position);
+
+    /*!
+     * Interpolates the gradient strength at a position on the triangle of the particle mesh that contains it
+     * @param position Coordinate3D object that contains the position of interest
+     * @param triangleHint int that contains the triangle of the previous query of the caller (-1 if unknown), is updated
+     * @return Double that contains the interpolated gradient strength
+     */
+    double getGradient(const Coordinate3D &position, int &triangleHint);
+
+    /*!
+     * Interpolates the concentration at a position on the triangle of the particle mesh that contains it
+     * @param position Coordinate3D object that contains the position of interest
+     * @param triangleHint int that contains the triangle of the previous query of the caller (-1 if unknown), is updated
+     * @return Double that contains the interpolated concentration
+     */
+    double getConcentration(const Coordinate3D &position, int &triangleHint);
+
+    /*!
+     * Interpolates the gradient at a position on the triangle of the particle mesh that contains it
+     * @param position Coordinate3D object that contains the position of interest
+     * @param triangleHint int that contains the triangle of the previous query of the caller (-1 if unknown), is updated
+     * @return Coordinate3D object that contains the interpolated gradient
+     */
+    Coordinate3D getGradientVector(const Coordinate3D &position, int &triangleHint);
+    [[nodiscard]] MeshInterpolation getMeshInterpolation() const { return meshInterpolation; };
     double getSumChemokine();
     bool steadyStateReached(double current_time);
+    /// Returns if the timestep may be increased once a steady state is reached (lookup only knows steady states for dc > 500)
+    [[nodiscard]] bool allowsSteadyState() const {
+        return speciesDCRatios.empty() &&
+               (steadyStateDetection != SteadyStateDetection::LOOKUP || steadyStateLibrary.isActive() || dc > 500);
+    };
     [[nodiscard]] double getDiffusionCoefficient() const { return dc; };
     [[nodiscard]] bool getallowHigherDT() const { return allowHigherDT; };
+    /// Returns if the chemokine field is loaded from the steady state library (the field is frozen, there is no uptake)
+    [[nodiscard]] bool usesSteadyStateLibrary() const { return steadyStateLibrary.isActive(); };
 
 private:
+    double concentrationStep(double timestep);
+    void recordResidual(double residual);
+    bool loadSteadyStateField(double time_delta);
+    void cleanUpChemotaxis();
+    void collectAECParticles(Site *site, double time_delta);
     void insertConcentrationAtArea(Site *site, double time_delta);
-    void addTriangle(unsigned int id1, unsigned int id2, unsigned int id3);
     void triangulationFromDirectInput(Site *site,
                                       const abm::util::SimulationParameters::ParticleManagerParameters &parameters,
                                       const std::string &input_dir);
     void extractTriangles();
+    std::array<unsigned int, 3> locateTriangle(const Coordinate3D &position, int &triangleHint);
+    void computeSlopeWeights();
+    void updateSlopes();
     int get_closest_AEC_ID(Coordinate3D position, int type);
+    /// Index of an AEC in the per AEC vectors: AEC1 first, followed by the AEC2
+    [[nodiscard]] int aecIndex(int type, int aecId) const {
+        return type == 1 ? aecId : static_cast<int>(alvEpithTypeOne.size()) + aecId;
+    };
 
-    std::vector<std::shared_ptr<Particle>> allParticles;
-    std::unique_ptr<StaticBalloonList> particleBalloonList;
-    std::map<unsigned int, Particle *> particleById;
-    unsigned int noOfParticles;
-    unsigned int idHandling;
-    ublas::compressed_matrix<double> P;
-    ublas::vector<double> concBlas;
-    ublas::vector<double> dConcBlas;
-    std::shared_ptr<Particle> conidiumParticle;
-    std::vector<std::shared_ptr<Particle>> aecParticles;
-    std::vector<int> aecParticlesCells;
+    ParticleStore particles;
+    std::vector<double> nextConcentrations;
+    std::vector<double> secretionRates;
+    std::vector<double> speciesDCRatios; // dc of each additional species divided by dc of the chemokine
+    std::vector<double> speciesSecretionRatios; // secretion of each additional species divided by the chemokine secretion
+    bool secretionRatesOutdated = true;
+    DiffusionMatrix diffusionMatrix;
+    DiffusionBackend diffusionBackend = DiffusionBackend::PARTICLE;
+    int diffusionThreads = 1;
+    bool implicitDiffusion = false;
+    bool activeSetDiffusion = false;
+    double activeSetThreshold = 0;
+    ActiveSet activeSet;
+    SteadyStateDetection steadyStateDetection = SteadyStateDetection::LOOKUP;
+    double steadyStateTolerance{};
+    int steadyStateWindow{};
+    int stepsBelowTolerance = 0;
+    double residualConidiaChange = -1;
+    std::vector<double> previousConcentrations; // "in site" concentrations before the step, in the order of inSiteIds
+    SteadyStateLibrary steadyStateLibrary;
+    double libraryConidiaChange = -1;
+    ImplicitDiffusionSolver implicitSolver;
+    std::unique_ptr<StaticBalloonList> particleBalloonList; // "in site" and boundary particles only
+    std::vector<Coordinate3D> outOfSitePositions; // "out of site" particles close to the active ones, only counted
+    std::vector<unsigned int> activeInputIds; // input ids of the "in site" and boundary particles (output order)
+    std::vector<Particle> aecParticles;
+    std::vector<int> aecParticlesCells; // AEC index of each AEC particle
+    std::vector<int> aecOwnerOfParticle; // AEC index that a particle secretes for (-1 if it does not secrete), per particle id
+    std::set<int> aecCells; // AEC index of each secreting cell
     std::vector<SphericCoordinate3D> alvEpithTypeOne;
     std::vector<SphericCoordinate3D> alvEpithTypeTwo;
     std::vector<TRIANGLE3D> triangles;
+    TriangleLocator triangleLocator;
+    MeshInterpolation meshInterpolation = MeshInterpolation::NONE;
+    // least squares slopes in the tangent plane of the first ring: slope of f at i = sum of weight_k (f_k - f_i)
+    std::vector<Coordinate3D> slopeWeights;
+    // slopes of the vertex data of the quadratic interpolation, the slopes of the gradients reach the second ring
+    std::vector<Coordinate3D> concentrationSlopes;
+    std::vector<Coordinate3D> gradientStrengthSlopes;
+    std::vector<std::array<Coordinate3D, 3>> gradientSlopes; // slopes of the x, y and z component of the gradients
+    bool slopesOutdated = true;
     std::string particleInputDelauneyFile;
-    double **conc;
+    unsigned int numberOfGeneratedParticles = 0; // particles of the generated mesh (0 for the particle-delauney input)
     double dc;
     double sumAreaAECParticles;
-    double sumAreaAEcParticlesCells[100];
-    double aecSecretionratePerGrid[100];
+    // per AEC index, sized by the number of AEC1 and AEC2 of the site
+    std::vector<double> sumAreaAEcParticlesCells;
+    std::vector<double> aecSecretionratePerGrid;
     double particleSecretionMoleculePerCellMin;
     bool allowHigherDT;
     bool clean_chemotaxis = true;
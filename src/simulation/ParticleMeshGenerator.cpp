@@ -0,0 +1,214 @@
+//  Copyright by Christoph Saffer, Paul Rudolph, Sandra Timme, Marco Blickensdorf, Johannes Pollmächer
+//  Research Group Applied Systems Biology - Head: Prof. Dr. Marc Thilo Figge
+//  https://www.leibniz-hki.de/en/applied-systems-biology.html
+//  HKI-Center for Systems Biology of Infection
+//  Leibniz Institute for Natural Product Research and Infection Biology - Hans Knöll Insitute (HKI)
+//  Adolf-Reichwein-Straße 23, 07745 Jena, Germany
+//
+//  This code is licensed under BSD 2-Clause
+//  See the LICENSE file provided with this code for the full license.
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "simulation/ParticleMeshGenerator.h"
+#include "utils/macros.h"
+
+namespace {
+    // vertex of a Voronoi cell in the gnomonic projection around its particle, the edge that starts at the vertex
+    // separates the cell from the particle "label" (-1 for an edge of the initial square)
+    struct CellVertex {
+        double x;
+        double y;
+        int label;
+    };
+
+    // Sutherland-Hodgman step: keeps the part of the cell that is closer to the particle than to the candidate,
+    // where a * x + b * y + c >= 0 in the gnomonic projection
+    void clipCell(std::vector<CellVertex> &cell, std::vector<CellVertex> &clipped,
+                  double a, double b, double c, int label) {
+        clipped.clear();
+        for (size_t k = 0; k < cell.size(); k++) {
+            const auto &from = cell[k];
+            const auto &to = cell[(k + 1) % cell.size()];
+            const double fromSide = a * from.x + b * from.y + c;
+            const double toSide = a * to.x + b * to.y + c;
+            if (fromSide >= 0) {
+                clipped.push_back(from);
+            }
+            if ((fromSide >= 0) != (toSide >= 0)) {
+                const double t = fromSide / (fromSide - toSide);
+                // leaving the half-plane the edge continues on the clip line, entering it on the original edge
+                clipped.push_back({from.x + t * (to.x - from.x), from.y + t * (to.y - from.y),
+                                   fromSide >= 0 ? label : from.label});
+            }
+        }
+        std::swap(cell, clipped);
+    }
+
+    // tangent basis of a unit vector u, (t1, t2, u) is right-handed (counterclockwise seen from outside)
+    std::pair<Coordinate3D, Coordinate3D> tangentBasis(const Coordinate3D &u) {
+        const Coordinate3D axis = std::abs(u.x) < 0.5 ? Coordinate3D{1, 0, 0} : Coordinate3D{0, 1, 0};
+        auto t1 = axis.crossProduct(u);
+        t1.setMagnitude(1);
+        return {t1, u.crossProduct(t1)};
+    }
+
+    // area of the spherical triangle of three unit vectors (Van Oosterom and Strackee)
+    double sphericalTriangleArea(const Coordinate3D &a, const Coordinate3D &b, const Coordinate3D &c) {
+        const double volume = std::abs(a.scalarProduct(b.crossProduct(c)));
+        return 2 * std::atan2(volume, 1 + a.scalarProduct(b) + b.scalarProduct(c) + c.scalarProduct(a));
+    }
+}
+
+ParticleMesh ParticleMeshGenerator::sphere(unsigned int numberOfParticles, double radius, const Coordinate3D &center) {
+    if (numberOfParticles < minNumberOfParticles) {
+        ERROR_STDERR("A generated particle mesh needs at least " << minNumberOfParticles << " particles");
+        exit(1);
+    }
+    const auto n = static_cast<size_t>(numberOfParticles);
+
+    // Fibonacci points: equal area bands in z, successive points are rotated by the golden angle
+    const double goldenAngle = M_PI * (3 - std::sqrt(5.0));
+    std::vector<Coordinate3D> units(n);
+    for (size_t i = 0; i < n; i++) {
+        const double z = 1 - (2.0 * static_cast<double>(i) + 1) / static_cast<double>(n);
+        const double r = std::sqrt(std::max(0.0, 1 - z * z));
+        const double phi = goldenAngle * static_cast<double>(i);
+        units[i] = {r * std::cos(phi), r * std::sin(phi), z};
+    }
+
+    // grid of the unit cube with about six particles per cell, sorted by cell so a cell is one range of the ids
+    const double spacing = std::sqrt(4 * M_PI / static_cast<double>(n));
+    const double cellSize = 2.5 * spacing;
+    const auto cellsPerAxis = static_cast<std::int64_t>(std::ceil(2 / cellSize)) + 1;
+    const auto cellIndex = [&](double value) {
+        return std::min(cellsPerAxis - 1, static_cast<std::int64_t>((value + 1) / cellSize));
+    };
+    const auto cellKey = [&](std::int64_t ix, std::int64_t iy, std::int64_t iz) {
+        return static_cast<std::uint64_t>((ix * cellsPerAxis + iy) * cellsPerAxis + iz);
+    };
+    std::vector<std::pair<std::uint64_t, unsigned int>> cells(n);
+    for (size_t i = 0; i < n; i++) {
+        cells[i] = {cellKey(cellIndex(units[i].x), cellIndex(units[i].y), cellIndex(units[i].z)),
+                    static_cast<unsigned int>(i)};
+    }
+    std::sort(cells.begin(), cells.end());
+
+    std::vector<std::vector<unsigned int>> neighbours(n);
+    std::vector<double> areas(n);
+    std::vector<std::pair<double, unsigned int>> candidates;
+    std::vector<CellVertex> cell, clipped;
+    for (size_t i = 0; i < n; i++) {
+        const auto &u = units[i];
+        const auto [t1, t2] = tangentBasis(u);
+
+        // a particle at (chord) distance d cuts the cell only if a vertex is farther than d / 2 from the particle,
+        // so the search radius is increased until it covers twice the distance of the farthest vertex
+        double searchRadius = cellSize;
+        for (;;) {
+            candidates.clear();
+            const auto reach = static_cast<std::int64_t>(std::ceil(searchRadius / cellSize));
+            const auto ix = cellIndex(u.x), iy = cellIndex(u.y), iz = cellIndex(u.z);
+            for (auto cx = std::max<std::int64_t>(0, ix - reach); cx <= std::min(cellsPerAxis - 1, ix + reach); cx++) {
+                for (auto cy = std::max<std::int64_t>(0, iy - reach); cy <= std::min(cellsPerAxis - 1, iy + reach); cy++) {
+                    const auto first = std::lower_bound(cells.begin(), cells.end(),
+                                                        std::make_pair(cellKey(cx, cy, std::max<std::int64_t>(0, iz - reach)), 0u));
+                    const auto last = std::lower_bound(first, cells.end(),
+                                                       std::make_pair(cellKey(cx, cy, std::min(cellsPerAxis - 1, iz + reach)) + 1, 0u));
+                    for (auto it = first; it != last; ++it) {
+                        const double distance = units[it->second].calculateEuclidianDistance(u);
+                        if (it->second != i && distance < searchRadius) {
+                            candidates.emplace_back(distance, it->second);
+                        }
+                    }
+                }
+            }
+            std::sort(candidates.begin(), candidates.end());
+
+            cell = {{-2, -2, -1}, {2, -2, -1}, {2, 2, -1}, {-2, 2, -1}};
+            double maxVertexDistance = 4;
+            for (const auto &[distance, j]: candidates) {
+                if (distance > 2 * maxVertexDistance) {
+                    break;
+                }
+                const auto d = u - units[j];
+                clipCell(cell, clipped, t1.scalarProduct(d), t2.scalarProduct(d), u.scalarProduct(d), static_cast<int>(j));
+                // the chord distance of a vertex grows with its distance in the projection
+                double maxProjectedDistance = 0;
+                for (const auto &vertex: cell) {
+                    maxProjectedDistance = std::max(maxProjectedDistance, vertex.x * vertex.x + vertex.y * vertex.y);
+                }
+                maxVertexDistance = std::sqrt(2 - 2 / std::sqrt(1 + maxProjectedDistance));
+            }
+            const bool bounded = std::none_of(cell.begin(), cell.end(), [](const CellVertex &v) { return v.label < 0; });
+            if (bounded && 2 * maxVertexDistance < searchRadius) {
+                break;
+            }
+            searchRadius *= 1.5;
+        }
+
+        // (nearly) cocircular particles produce edges of zero length, they are no neighbours
+        const double minEdgeLength = 1e-9 * spacing;
+        std::vector<Coordinate3D> vertices;
+        for (size_t k = 0; k < cell.size(); k++) {
+            const auto &next = cell[(k + 1) % cell.size()];
+            if (std::hypot(next.x - cell[k].x, next.y - cell[k].y) > minEdgeLength) {
+                neighbours[i].push_back(static_cast<unsigned int>(cell[k].label));
+            }
+            auto onSphere = u + t1 * cell[k].x + t2 * cell[k].y;
+            onSphere.setMagnitude(1);
+            vertices.push_back(onSphere);
+        }
+        double area = 0;
+        for (size_t k = 0; k < vertices.size(); k++) {
+            area += sphericalTriangleArea(u, vertices[k], vertices[(k + 1) % vertices.size()]);
+        }
+        areas[i] = area * radius * radius;
+    }
+
+    // rounding may keep an edge for one of its particles only, the neighbourhood is made symmetric
+    std::vector<bool> completed(n, false);
+    for (size_t i = 0; i < n; i++) {
+        for (const auto j: neighbours[i]) {
+            auto &other = neighbours[j];
+            if (std::find(other.begin(), other.end(), i) == other.end()) {
+                other.push_back(static_cast<unsigned int>(i));
+                completed[j] = true;
+            }
+        }
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (completed[i]) {
+            // the added neighbours are sorted into their angular position, the neighbours stay counterclockwise
+            const auto basis = tangentBasis(units[i]);
+            const auto angle = [&](unsigned int j) {
+                const auto d = units[j] - units[i];
+                return std::atan2(basis.second.scalarProduct(d), basis.first.scalarProduct(d));
+            };
+            std::sort(neighbours[i].begin(), neighbours[i].end(),
+                      [&](unsigned int a, unsigned int b) { return angle(a) < angle(b); });
+        }
+    }
+
+    ParticleMesh mesh;
+    mesh.positions.reserve(3 * n);
+    mesh.neighbourOffsets.reserve(n + 1);
+    mesh.neighbourOffsets.push_back(0);
+    for (size_t i = 0; i < n; i++) {
+        const auto position = center + units[i] * radius;
+        mesh.positions.insert(mesh.positions.end(), {position.x, position.y, position.z});
+        for (const auto j: neighbours[i]) {
+            mesh.neighbourIds.push_back(j);
+            mesh.contactAreas.push_back(units[i].calculateEuclidianDistance(units[j]) * radius);
+        }
+        mesh.neighbourOffsets.push_back(static_cast<std::uint32_t>(mesh.neighbourIds.size()));
+    }
+    mesh.areas = std::move(areas);
+    mesh.concentrations.assign(n, 0);
+    return mesh;
+}
@@ -0,0 +1,39 @@
+//  Copyright by Christoph Saffer, Paul Rudolph, Sandra Timme, Marco Blickensdorf, Johannes Pollmächer
+//  Research Group Applied Systems Biology - Head: Prof. Dr. Marc Thilo Figge
+//  https://www.leibniz-hki.de/en/applied-systems-biology.html
+//  HKI-Center for Systems Biology of Infection
+//  Leibniz Institute for Natural Product Research and Infection Biology - Hans Knöll Insitute (HKI)
+//  Adolf-Reichwein-Straße 23, 07745 Jena, Germany
+//
+//  This code is licensed under BSD 2-Clause
+//  See the LICENSE file provided with this code for the full license.
+
+
+#ifndef PARTICLEMESHGENERATOR_H
+#define PARTICLEMESHGENERATOR_H
+
+#include "basic/Coordinate3D.h"
+#include "io/ParticleMeshFile.h"
+
+class ParticleMeshGenerator {
+public:
+    /// Class for the generation of particle meshes on a sphere at any resolution, without particle-delauney input
+    ParticleMeshGenerator() = delete;
+
+    /// Smallest number of particles, every Voronoi cell lies well inside of the hemisphere around its particle
+    static constexpr unsigned int minNumberOfParticles = 64;
+
+    /*!
+     * Generates a quasi-uniform mesh on the full sphere (Fibonacci points), the "in site" flags are set by the site
+     * Neighbours are the spherical Delaunay neighbours (particles with a common Voronoi edge) in counterclockwise
+     * order, areas are the spherical Voronoi areas and the contact areas follow the particle-delauney inputs
+     * (distance between the neighbours), so generated meshes and inputs of the same resolution are interchangeable
+     * @param numberOfParticles unsigned int that contains the number of particles
+     * @param radius Double that contains the radius of the sphere
+     * @param center Coordinate3D object that contains the center of the sphere
+     * @return ParticleMesh object that contains the mesh
+     */
+    static ParticleMesh sphere(unsigned int numberOfParticles, double radius, const Coordinate3D &center);
+};
+
+#endif    /* PARTICLEMESHGENERATOR_H */
@@ -12,39 +12,40 @@
 
 #include "simulation/ParticleNeighbourList.h"
 #include "simulation/Particle.h"
+#include "simulation/ParticleTopology.h"
 
 
-void ParticleNeighbourList::addNeighbour(Particle *p, double contactArea) {
-
-    double distance;
-    double preFactorPSE;
-    double preFactorGradient;
+template<typename T>
+NeighbourSpan<T> ParticleNeighbourList::getRow(const std::vector<T> &values) const {
+    const auto &offsets = store->topology->getNeighbourOffsets();
+    return {values.data() + offsets[id], values.data() + offsets[id + 1]};
+}
 
-    if (!existsInList(p)) {
-        neighbourParticles.push_back(p);
-        distance = p->getPosition().calculateEuclidianDistance(particle->getPosition());
-        neighbourDistances.push_back(distance);
-        neighbourContactArea.push_back(contactArea);
+NeighbourSpan<unsigned int> ParticleNeighbourList::getNeighbourIds() const {
+    return getRow(store->topology->getNeighbourIds());
+}
 
-        preFactorPSE = particle->getDiffusionCoefficient() * contactArea / (distance * particle->getArea());
-        preFactorsPSE.push_back(preFactorPSE);
+NeighbourSpan<double> ParticleNeighbourList::getDistances() const {
+    return getRow(store->topology->getDistances());
+}
 
-        preFactorGradient = contactArea / (distance * particle->getArea());
-        preFactorsGradient.push_back(preFactorGradient);
+NeighbourSpan<double> ParticleNeighbourList::getContactAreas() const {
+    return getRow(store->topology->getContactAreas());
+}
 
-    }
+NeighbourSpan<double> ParticleNeighbourList::getPreFactorsPSE() const {
+    return getRow(store->topology->getPreFactorsPSE());
 }
 
-bool ParticleNeighbourList::existsInList(Particle *p) {
-    bool isIn = false;
+NeighbourSpan<double> ParticleNeighbourList::getPreFactorsGradient() const {
+    return getRow(store->topology->getPreFactorsGradient());
+}
 
-    auto it = neighbourParticles.begin();
-    while (it != neighbourParticles.end()) {
-        if ((*it) == p) {
-            isIn = true;
-            break;
+bool ParticleNeighbourList::existsInList(const Particle &p) const {
+    for (const auto neighbourId: getNeighbourIds()) {
+        if (neighbourId == p.getId()) {
+            return true;
         }
-        it++;
     }
-    return isIn;
-}
\ No newline at end of file
+    return false;
+}
@@ -11,32 +11,51 @@
 #ifndef PARTICLENEIGHBOURLIST_H
 #define    PARTICLENEIGHBOURLIST_H
 
+#include <cstddef>
 #include <vector>
 
 class Particle;
+struct ParticleStore;
+
+/// Read-only view of the contiguous row of one particle in an array of the ParticleTopology (no copy, no allocation)
+template<typename T>
+class NeighbourSpan {
+public:
+    NeighbourSpan(const T *first, const T *last) : first(first), last(last) {};
+
+    [[nodiscard]] const T *begin() const { return first; };
+    [[nodiscard]] const T *end() const { return last; };
+    [[nodiscard]] size_t size() const { return static_cast<size_t>(last - first); };
+    [[nodiscard]] bool empty() const { return first == last; };
+    const T &operator[](size_t i) const { return first[i]; };
+
+private:
+    const T *first;
+    const T *last;
+};
 
 class ParticleNeighbourList {
   public:
     /// Class for implementation of grid-based particle interaction and diffusion
+    /// View of the neighbours of one particle, distances, contact areas and prefactors are read from the shared ParticleTopology
+    /// All rows are returned as spans in the same neighbour order: entry k of every span belongs to the same neighbour
     ParticleNeighbourList() {};
-    ParticleNeighbourList(Particle *p) { particle = p; };
+    ParticleNeighbourList(const ParticleStore *store, unsigned int id) : store(store), id(id) {};
 
-    void addNeighbour(Particle *particle, double contactArea);
-    bool existsInList(Particle *p);
+    bool existsInList(const Particle &p) const;
 
-    std::vector<Particle *> &getNeighbours() { return neighbourParticles; };
-    std::vector<double> &getDistances() { return neighbourDistances; };
-    std::vector<double> &getContactAreas() { return neighbourContactArea; };
-    std::vector<double> &getPreFactorsPSE() { return preFactorsPSE; };
-    std::vector<double> &getPreFactorsGradient() { return preFactorsGradient; };
+    [[nodiscard]] NeighbourSpan<unsigned int> getNeighbourIds() const;
+    [[nodiscard]] NeighbourSpan<double> getDistances() const;
+    [[nodiscard]] NeighbourSpan<double> getContactAreas() const;
+    [[nodiscard]] NeighbourSpan<double> getPreFactorsPSE() const;
+    [[nodiscard]] NeighbourSpan<double> getPreFactorsGradient() const;
 
 private:
-    Particle *particle;
-    std::vector<Particle *> neighbourParticles;
-    std::vector<double> neighbourDistances;
-    std::vector<double> neighbourContactArea;
-    std::vector<double> preFactorsPSE;
-    std::vector<double> preFactorsGradient;
+    template<typename T>
+    NeighbourSpan<T> getRow(const std::vector<T> &values) const;
+
+    const ParticleStore *store{};
+    unsigned int id{};
 };
 
 #endif    /* PARTICLENEIGHBOURLIST_H */
@@ -0,0 +1,42 @@
+//  Copyright by Christoph Saffer, Paul Rudolph, Sandra Timme, Marco Blickensdorf, Johannes Pollmächer
+//  Research Group Applied Systems Biology - Head: Prof. Dr. Marc Thilo Figge
+//  https://www.leibniz-hki.de/en/applied-systems-biology.html
+//  HKI-Center for Systems Biology of Infection
+//  Leibniz Institute for Natural Product Research and Infection Biology - Hans Knöll Insitute (HKI)
+//  Adolf-Reichwein-Straße 23, 07745 Jena, Germany
+//
+//  This code is licensed under BSD 2-Clause
+//  See the LICENSE file provided with this code for the full license.
+
+
+#ifndef PARTICLESTORE_H
+#define PARTICLESTORE_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "simulation/ParticleTopology.h"
+
+/// State of all particles of one run as plain arrays indexed by the particle id, the mesh itself is shared (ParticleTopology)
+/// Particle objects are handles into this store, there are no per-particle heap objects
+struct ParticleStore {
+    std::shared_ptr<const ParticleTopology> topology;
+    std::vector<double> concentrations;
+    std::vector<double> concentrationChanges;
+    // additional molecule species beside the chemokine, interleaved per particle (species s of particle i is stored
+    // at i * numberOfAdditionalSpecies + s), so one traversal of a neighbour row reads all species of a neighbour
+    unsigned int numberOfAdditionalSpecies = 0;
+    std::vector<double> speciesConcentrations;
+    std::vector<double> speciesConcentrationChanges;
+    std::vector<std::uint8_t> inSite; // only "in site" particles take part in the diffusion
+    std::vector<std::uint8_t> atBoundary; // "out of site" particles with an "in site" neighbour
+    // ascending ids of the "in site" particles, the only ones visited by the per-step loops
+    std::vector<unsigned int> inSiteIds;
+
+    // gradients of all particles, evaluated at once on the first query after the concentrations changed
+    std::vector<Coordinate3D> gradients;
+    bool gradientsOutdated = true;
+};
+
+#endif    /* PARTICLESTORE_H */
@@ -0,0 +1,315 @@
+//  Copyright by Christoph Saffer, Paul Rudolph, Sandra Timme, Marco Blickensdorf, Johannes Pollmächer
+//  Research Group Applied Systems Biology - Head: Prof. Dr. Marc Thilo Figge
+//  https://www.leibniz-hki.de/en/applied-systems-biology.html
+//  HKI-Center for Systems Biology of Infection
+//  Leibniz Institute for Natural Product Research and Infection Biology - Hans Knöll Insitute (HKI)
+//  Adolf-Reichwein-Straße 23, 07745 Jena, Germany
+//
+//  This code is licensed under BSD 2-Clause
+//  See the LICENSE file provided with this code for the full license.
+
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_set>
+
+#include <boost/filesystem.hpp>
+
+#include "simulation/ParticleTopology.h"
+#include "io/ParticleMeshFile.h"
+#include "utils/macros.h"
+
+namespace {
+    constexpr unsigned int curveBits = 21; // bits per axis, a key of three axes fits into 64 bits
+
+    // spreads the lowest 21 bits of a value to every third bit
+    std::uint64_t spreadBits(std::uint64_t value) {
+        value &= 0x1fffff;
+        value = (value | value << 32) & 0x1f00000000ffff;
+        value = (value | value << 16) & 0x1f0000ff0000ff;
+        value = (value | value << 8) & 0x100f00f00f00f00f;
+        value = (value | value << 4) & 0x10c30c30c30c30c3;
+        value = (value | value << 2) & 0x1249249249249249;
+        return value;
+    }
+
+    std::uint64_t mortonKey(const std::array<std::uint32_t, 3> &cell) {
+        return spreadBits(cell[0]) << 2 | spreadBits(cell[1]) << 1 | spreadBits(cell[2]);
+    }
+
+    // Skilling, "Programming the Hilbert curve" (2004): the cell is transformed to the transposed Hilbert index,
+    // interleaving its bits (most significant axis first) gives the position on the curve
+    std::uint64_t hilbertKey(std::array<std::uint32_t, 3> cell) {
+        for (std::uint32_t q = 1u << (curveBits - 1); q > 1; q >>= 1) {
+            const std::uint32_t p = q - 1;
+            for (auto &axis: cell) {
+                if (axis & q) {
+                    cell[0] ^= p;
+                } else {
+                    const std::uint32_t t = (cell[0] ^ axis) & p;
+                    cell[0] ^= t;
+                    axis ^= t;
+                }
+            }
+        }
+        cell[1] ^= cell[0];
+        cell[2] ^= cell[1];
+        std::uint32_t t = 0;
+        for (std::uint32_t q = 1u << (curveBits - 1); q > 1; q >>= 1) {
+            if (cell[2] & q) {
+                t ^= q - 1;
+            }
+        }
+        for (auto &axis: cell) {
+            axis ^= t;
+        }
+        return mortonKey(cell);
+    }
+
+    // sorts the particles by their key on a space filling curve through the bounding box of the positions
+    template<typename Key>
+    std::vector<unsigned int> curveOrder(size_t numberOfParticles, const double *positions, Key key) {
+        std::array<double, 3> lower{}, upper{};
+        for (unsigned int axis = 0; axis < 3; axis++) {
+            lower[axis] = upper[axis] = numberOfParticles > 0 ? positions[axis] : 0.0;
+        }
+        for (size_t i = 0; i < numberOfParticles; i++) {
+            for (unsigned int axis = 0; axis < 3; axis++) {
+                lower[axis] = std::min(lower[axis], positions[3 * i + axis]);
+                upper[axis] = std::max(upper[axis], positions[3 * i + axis]);
+            }
+        }
+        const double cells = static_cast<double>((1u << curveBits) - 1);
+        std::vector<std::uint64_t> keys(numberOfParticles);
+        for (size_t i = 0; i < numberOfParticles; i++) {
+            std::array<std::uint32_t, 3> cell{};
+            for (unsigned int axis = 0; axis < 3; axis++) {
+                const double extent = upper[axis] - lower[axis];
+                cell[axis] = extent > 0 ? static_cast<std::uint32_t>((positions[3 * i + axis] - lower[axis]) / extent * cells) : 0;
+            }
+            keys[i] = key(cell);
+        }
+        std::vector<unsigned int> order(numberOfParticles);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&keys](unsigned int a, unsigned int b) { return keys[a] < keys[b]; });
+        return order;
+    }
+
+    // breadth-first search from a particle of minimal degree per connected component, neighbours by increasing degree
+    std::vector<unsigned int> reverseCuthillMcKee(size_t numberOfParticles,
+                                                  const std::uint32_t *offsets,
+                                                  const std::uint32_t *neighbourIds) {
+        const auto degree = [offsets](unsigned int particle) { return offsets[particle + 1] - offsets[particle]; };
+        const auto byDegree = [&degree](unsigned int a, unsigned int b) { return degree(a) < degree(b); };
+        std::vector<unsigned int> starts(numberOfParticles);
+        std::iota(starts.begin(), starts.end(), 0);
+        std::stable_sort(starts.begin(), starts.end(), byDegree);
+
+        std::vector<std::uint8_t> visited(numberOfParticles, 0);
+        std::vector<unsigned int> order;
+        order.reserve(numberOfParticles);
+        for (const auto start: starts) {
+            if (visited[start]) {
+                continue;
+            }
+            visited[start] = 1;
+            order.push_back(start);
+            for (size_t head = order.size() - 1; head < order.size(); head++) {
+                const auto rowBegin = order.size();
+                for (auto k = offsets[order[head]]; k < offsets[order[head] + 1]; k++) {
+                    if (!visited[neighbourIds[k]]) {
+                        visited[neighbourIds[k]] = 1;
+                        order.push_back(neighbourIds[k]);
+                    }
+                }
+                std::stable_sort(order.begin() + static_cast<std::ptrdiff_t>(rowBegin), order.end(), byDegree);
+            }
+        }
+        std::reverse(order.begin(), order.end());
+        return order;
+    }
+}
+
+ParticleOrdering ParticleTopology::orderingFromString(const std::string &name) {
+    if (name == "none") {
+        return ParticleOrdering::NONE;
+    }
+    if (name == "morton") {
+        return ParticleOrdering::MORTON;
+    }
+    if (name == "hilbert") {
+        return ParticleOrdering::HILBERT;
+    }
+    if (name == "rcm") {
+        return ParticleOrdering::RCM;
+    }
+    ERROR_STDERR("Unknown particle ordering: " << name);
+    exit(1);
+}
+
+std::shared_ptr<const ParticleTopology> ParticleTopology::load(const std::string &xmlFile, double dc,
+                                                               ParticleOrdering ordering) {
+    // the XML input is only parsed once, afterwards the binary cache next to it is memory-mapped
+    const auto meshFile = ParticleMeshFile::cachePath(xmlFile);
+    ParticleMeshFile mappedMesh;
+    ParticleMesh xmlMesh;
+    // without the XML input the cache is used as it is, otherwise it has to be newer than the input and of its size
+    bool cacheIsCurrent = mappedMesh.open(meshFile);
+    if (cacheIsCurrent && boost::filesystem::exists(xmlFile)) {
+        cacheIsCurrent = boost::filesystem::last_write_time(meshFile) >= boost::filesystem::last_write_time(xmlFile) &&
+                         mappedMesh.getSourceSize() == boost::filesystem::file_size(xmlFile);
+    }
+    if (!cacheIsCurrent) {
+        mappedMesh = ParticleMeshFile();
+        DEBUG_STDOUT("Converting particle mesh " << xmlFile << " to " << meshFile);
+        xmlMesh = ParticleMeshFile::readXML(xmlFile);
+        if (!ParticleMeshFile::write(meshFile, xmlMesh) || !mappedMesh.open(meshFile)) {
+            DEBUG_STDOUT("Could not write particle mesh cache " << meshFile << ", using the XML input");
+        }
+    }
+    const bool mapped = mappedMesh.getNumberOfParticles() > 0;
+    const auto numberOfParticles = mapped ? mappedMesh.getNumberOfParticles() : xmlMesh.areas.size();
+    const auto *meshPositions = mapped ? mappedMesh.getPositions() : xmlMesh.positions.data();
+    const auto *meshAreas = mapped ? mappedMesh.getAreas() : xmlMesh.areas.data();
+    const auto *meshConcentrations = mapped ? mappedMesh.getConcentrations() : xmlMesh.concentrations.data();
+    const auto *meshOffsets = mapped ? mappedMesh.getNeighbourOffsets() : xmlMesh.neighbourOffsets.data();
+    const auto *meshNeighbourIds = mapped ? mappedMesh.getNeighbourIds() : xmlMesh.neighbourIds.data();
+    const auto *meshContactAreas = mapped ? mappedMesh.getContactAreas() : xmlMesh.contactAreas.data();
+
+    auto topology = build(numberOfParticles, meshPositions, meshAreas, meshConcentrations, meshOffsets, meshNeighbourIds,
+                          meshContactAreas, dc, ordering);
+    topology->file = xmlFile;
+    return topology;
+}
+
+std::shared_ptr<const ParticleTopology> ParticleTopology::fromMesh(const ParticleMesh &mesh, double dc,
+                                                                   ParticleOrdering ordering) {
+    return build(mesh.areas.size(), mesh.positions.data(), mesh.areas.data(), mesh.concentrations.data(),
+                 mesh.neighbourOffsets.data(), mesh.neighbourIds.data(), mesh.contactAreas.data(), dc, ordering);
+}
+
+std::shared_ptr<ParticleTopology> ParticleTopology::build(size_t numberOfParticles,
+                                                          const double *meshPositions,
+                                                          const double *meshAreas,
+                                                          const double *meshConcentrations,
+                                                          const std::uint32_t *meshOffsets,
+                                                          const std::uint32_t *meshNeighbourIds,
+                                                          const double *meshContactAreas,
+                                                          double dc,
+                                                          ParticleOrdering ordering) {
+    auto topology = std::make_shared<ParticleTopology>();
+    topology->dc = dc;
+    topology->ordering = ordering;
+    switch (ordering) {
+        case ParticleOrdering::NONE:
+            topology->inputIds.resize(numberOfParticles);
+            std::iota(topology->inputIds.begin(), topology->inputIds.end(), 0);
+            break;
+        case ParticleOrdering::MORTON:
+            topology->inputIds = curveOrder(numberOfParticles, meshPositions, mortonKey);
+            break;
+        case ParticleOrdering::HILBERT:
+            topology->inputIds = curveOrder(numberOfParticles, meshPositions, hilbertKey);
+            break;
+        case ParticleOrdering::RCM:
+            topology->inputIds = reverseCuthillMcKee(numberOfParticles, meshOffsets, meshNeighbourIds);
+            break;
+    }
+    topology->idsOfInputIds.resize(numberOfParticles);
+    for (unsigned int i = 0; i < numberOfParticles; i++) {
+        topology->idsOfInputIds[topology->inputIds[i]] = i;
+    }
+
+    // particle i is the particle inputIds[i] of the mesh, its neighbours keep their order so the sums of a row do not change
+    topology->positions.reserve(numberOfParticles);
+    topology->areas.reserve(numberOfParticles);
+    topology->initialConcentrations.reserve(numberOfParticles);
+    for (size_t i = 0; i < numberOfParticles; i++) {
+        const auto input = topology->inputIds[i];
+        topology->positions.push_back(Coordinate3D{meshPositions[3 * input], meshPositions[3 * input + 1], meshPositions[3 * input + 2]});
+        topology->areas.push_back(meshAreas[input]);
+        topology->initialConcentrations.push_back(meshConcentrations[input]);
+    }
+
+    topology->neighbourOffsets.assign(1, 0);
+    for (size_t i = 0; i < numberOfParticles; i++) {
+        const auto rowBegin = topology->neighbourIds.size();
+        const auto input = topology->inputIds[i];
+        for (auto k = meshOffsets[input]; k < meshOffsets[input + 1]; k++) {
+            const auto neighbour = topology->idsOfInputIds[meshNeighbourIds[k]];
+            // a neighbour that is listed twice keeps its first contact area
+            if (std::find(topology->neighbourIds.begin() + rowBegin, topology->neighbourIds.end(), neighbour) !=
+                topology->neighbourIds.end()) {
+                continue;
+            }
+            const double distance = topology->positions[neighbour].calculateEuclidianDistance(topology->positions[i]);
+            const double contactArea = meshContactAreas[k];
+            topology->neighbourIds.push_back(neighbour);
+            topology->distances.push_back(distance);
+            topology->contactAreas.push_back(contactArea);
+            topology->preFactorsPSE.push_back(dc * contactArea / (distance * topology->areas[i]));
+            topology->preFactorsGradient.push_back(contactArea / (distance * topology->areas[i]));
+            topology->gradientDirections.push_back(topology->positions[neighbour] - topology->positions[i]);
+            topology->gradientWeights.push_back(0.5 * topology->preFactorsGradient.back());
+        }
+        topology->neighbourOffsets.push_back(static_cast<unsigned int>(topology->neighbourIds.size()));
+    }
+    return topology;
+}
+
+void ParticleTopology::evaluateGradients(const std::vector<double> &concentrations,
+                                         const std::vector<unsigned int> &rows,
+                                         std::vector<Coordinate3D> &gradients) const {
+    for (const auto i: rows) { //only "in site" grid points are used for the calculations
+        Coordinate3D gradient = Coordinate3D();
+        for (auto k = neighbourOffsets[i]; k < neighbourOffsets[i + 1]; k++) {
+            //Sukumar et al.
+            Coordinate3D curGradient{gradientDirections[k]};
+            curGradient *= gradientWeights[k] * (concentrations[neighbourIds[k]] - concentrations[i]);
+            gradient += curGradient;
+        }
+        gradients[i] = gradient;
+    }
+}
+
+const std::vector<std::array<unsigned int, 3>> &ParticleTopology::getTriangles() const {
+    std::call_once(trianglesExtracted, [this]() { extractTriangles(); });
+    return triangles;
+}
+
+namespace {
+    struct TriangleHash {
+        size_t operator()(const std::array<unsigned int, 3> &t) const {
+            return (static_cast<size_t>(t[0]) * 73856093u) ^ (static_cast<size_t>(t[1]) * 19349663u) ^
+                   (static_cast<size_t>(t[2]) * 83492791u);
+        }
+    };
+}
+
+void ParticleTopology::extractTriangles() const {
+    const auto isNeighbour = [this](unsigned int particle, unsigned int neighbour) {
+        return std::find(neighbourIds.begin() + neighbourOffsets[particle],
+                         neighbourIds.begin() + neighbourOffsets[particle + 1], neighbour) !=
+               neighbourIds.begin() + neighbourOffsets[particle + 1];
+    };
+
+    // each triangle is found from all of its vertices, the sorted vertex ids identify it in the hash set
+    std::unordered_set<std::array<unsigned int, 3>, TriangleHash> known;
+    known.reserve(2 * getNumberOfParticles());
+    triangles.clear();
+    for (unsigned int p = 0; p < getNumberOfParticles(); p++) {
+        for (auto i = neighbourOffsets[p]; i < neighbourOffsets[p + 1]; i++) {
+            //check if neighbours (i,j) are neighbours of each other
+            for (auto j = i + 1; j < neighbourOffsets[p + 1]; j++) {
+                if (!isNeighbour(neighbourIds[i], neighbourIds[j])) {
+                    continue;
+                }
+                std::array<unsigned int, 3> triangle{p, neighbourIds[i], neighbourIds[j]};
+                std::sort(triangle.begin(), triangle.end());
+                if (known.insert(triangle).second) {
+                    triangles.push_back(triangle);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,136 @@
+//  Copyright by Christoph Saffer, Paul Rudolph, Sandra Timme, Marco Blickensdorf, Johannes Pollmächer
+//  Research Group Applied Systems Biology - Head: Prof. Dr. Marc Thilo Figge
+//  https://www.leibniz-hki.de/en/applied-systems-biology.html
+//  HKI-Center for Systems Biology of Infection
+//  Leibniz Institute for Natural Product Research and Infection Biology - Hans Knöll Insitute (HKI)
+//  Adolf-Reichwein-Straße 23, 07745 Jena, Germany
+//
+//  This code is licensed under BSD 2-Clause
+//  See the LICENSE file provided with this code for the full license.
+
+
+#ifndef PARTICLETOPOLOGY_H
+#define PARTICLETOPOLOGY_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "basic/Coordinate3D.h"
+
+struct ParticleMesh;
+
+enum class ParticleOrdering {
+    NONE, // order of the input file
+    MORTON, // Z-order curve over the bounding box of the positions
+    HILBERT, // Hilbert curve over the bounding box of the positions
+    RCM // reverse Cuthill-McKee on the neighbour graph
+};
+
+class ParticleTopology {
+public:
+    /// Class for the immutable part of the particle mesh (positions, areas and neighbourhood including PSE prefactors)
+    /// It is loaded once per Simulator and shared read-only by all runs, each run only owns its concentrations
+    ParticleTopology() = default;
+
+    /*!
+     * Loads a particle-delauney input, its binary cache is used (and written on first use) as ParticleMeshFile
+     * @param xmlFile String that contains the path of the particle-delauney XML input
+     * @param dc Double that contains the diffusion coefficient of the PSE prefactors
+     * @param ordering ParticleOrdering that renumbers the particles to place neighbours close in memory
+     * @return ParticleTopology object
+     */
+    static std::shared_ptr<const ParticleTopology> load(const std::string &xmlFile, double dc,
+                                                       ParticleOrdering ordering = ParticleOrdering::NONE);
+
+    /*!
+     * Creates the topology of a mesh that is already in memory, e.g. a generated mesh
+     * @param mesh ParticleMesh object
+     * @param dc Double that contains the diffusion coefficient of the PSE prefactors
+     * @param ordering ParticleOrdering that renumbers the particles to place neighbours close in memory
+     * @return ParticleTopology object
+     */
+    static std::shared_ptr<const ParticleTopology> fromMesh(const ParticleMesh &mesh, double dc,
+                                                           ParticleOrdering ordering = ParticleOrdering::NONE);
+
+    /*!
+     * Parses a particle ordering from a String ("none", "morton", "hilbert" or "rcm")
+     * @param name String that contains the name of the ordering
+     * @return ParticleOrdering that is used by load() and fromMesh()
+     */
+    static ParticleOrdering orderingFromString(const std::string &name);
+
+    [[nodiscard]] size_t getNumberOfParticles() const { return areas.size(); }
+    [[nodiscard]] double getDiffusionCoefficient() const { return dc; }
+    [[nodiscard]] const std::string &getFile() const { return file; }
+    [[nodiscard]] const std::vector<Coordinate3D> &getPositions() const { return positions; }
+    [[nodiscard]] const std::vector<double> &getAreas() const { return areas; }
+    [[nodiscard]] const std::vector<double> &getInitialConcentrations() const { return initialConcentrations; }
+    [[nodiscard]] ParticleOrdering getOrdering() const { return ordering; }
+    /// Returns the id of each particle in the input (its position in the mesh file), used for the output
+    [[nodiscard]] const std::vector<unsigned int> &getInputIds() const { return inputIds; }
+    /// Returns the particle id of each input id
+    [[nodiscard]] const std::vector<unsigned int> &getIdsOfInputIds() const { return idsOfInputIds; }
+
+    // neighbourhood in compressed sparse row format, the neighbours of particle i are in [offsets[i], offsets[i + 1])
+    [[nodiscard]] const std::vector<unsigned int> &getNeighbourOffsets() const { return neighbourOffsets; }
+    [[nodiscard]] const std::vector<unsigned int> &getNeighbourIds() const { return neighbourIds; }
+    [[nodiscard]] const std::vector<double> &getDistances() const { return distances; }
+    [[nodiscard]] const std::vector<double> &getContactAreas() const { return contactAreas; }
+    [[nodiscard]] const std::vector<double> &getPreFactorsPSE() const { return preFactorsPSE; }
+    [[nodiscard]] const std::vector<double> &getPreFactorsGradient() const { return preFactorsGradient; }
+
+    /*!
+     * Evaluates the gradient operator (Sukumar et al.) at the given particles, the other gradients are left unchanged
+     * ("out of site" particles keep their zero gradient)
+     * @param concentrations vector of Double that contains the current concentrations of all particles
+     * @param rows vector of unsigned int that contains the ids of the "in site" particles
+     * @param gradients vector of Coordinate3D that receives the gradients of all particles (sized by the caller)
+     */
+    void evaluateGradients(const std::vector<double> &concentrations,
+                           const std::vector<unsigned int> &rows,
+                           std::vector<Coordinate3D> &gradients) const;
+
+    /// Returns the triangles of the mesh (three mutual neighbours, sorted vertex ids), extracted once on the first call
+    [[nodiscard]] const std::vector<std::array<unsigned int, 3>> &getTriangles() const;
+
+private:
+    static std::shared_ptr<ParticleTopology> build(size_t numberOfParticles,
+                                                   const double *meshPositions,
+                                                   const double *meshAreas,
+                                                   const double *meshConcentrations,
+                                                   const std::uint32_t *meshOffsets,
+                                                   const std::uint32_t *meshNeighbourIds,
+                                                   const double *meshContactAreas,
+                                                   double dc,
+                                                   ParticleOrdering ordering);
+    void extractTriangles() const;
+
+    std::string file;
+    double dc{};
+    ParticleOrdering ordering = ParticleOrdering::NONE;
+    std::vector<unsigned int> inputIds;
+    std::vector<unsigned int> idsOfInputIds;
+    std::vector<Coordinate3D> positions;
+    std::vector<double> areas;
+    std::vector<double> initialConcentrations;
+    std::vector<unsigned int> neighbourOffsets;
+    std::vector<unsigned int> neighbourIds;
+    std::vector<double> distances;
+    std::vector<double> contactAreas;
+    std::vector<double> preFactorsPSE;
+    std::vector<double> preFactorsGradient;
+
+    // sparse gradient operator, entry k contributes gradientDirections[k] * gradientWeights[k] * (c_neighbour - c_particle)
+    std::vector<Coordinate3D> gradientDirections;
+    std::vector<double> gradientWeights;
+
+    // the topology is shared by runs in parallel, the triangles are extracted by the first run that needs them
+    mutable std::vector<std::array<unsigned int, 3>> triangles;
+    mutable std::once_flag trianglesExtracted;
+};
+
+#endif    /* PARTICLETOPOLOGY_H */
@@ -38,8 +38,7 @@ void Site::doAgentDynamics(Randomizer *random_generator, const SimulationTime &t
     const auto max_time = time.getMaxTime();
 
     const auto &all_agents = agent_manager_->getAllAgents();
-    auto &all_particles = particle_manager_->getAllParticles();
-    if (!all_agents.empty() || !all_particles.empty()) {
+    if (!all_agents.empty() || particle_manager_->getNumberOfParticles() > 0) {
         // Loop over all agents (random order)
         const auto current_order = Algorithms::generateRandomPermutation(random_generator, all_agents.size());
         for (auto agent_idx = current_order.begin(); agent_idx < current_order.end(); ++agent_idx) {
@@ -58,19 +57,19 @@ void Site::doAgentDynamics(Randomizer *random_generator, const SimulationTime &t
             }
         }
 
+        // add the uptake of all agents in the order of the agent phase, whatever order they were processed in
+        for (const auto agent_idx: current_order) {
+            const auto &curr_agent = all_agents[agent_idx];
+            if (nullptr != curr_agent && !curr_agent->particle_uptake.empty()) {
+                particle_manager_->addUptake(curr_agent->particle_uptake);
+                curr_agent->particle_uptake.clear();
+            }
+        }
+
         // Loop over all particles if steady state is not reached
         if (!particle_manager_->steadyStateReached(current_time)) {
-            all_particles = particle_manager_->getAllParticles();
-            for (const auto &cur_particle : all_particles) {
-                // Do all actions for one timestep for each particle
-                cur_particle->doAllActionsForTimestep(dt);
-            }
-            // Initialize Particles
-            particle_manager_->inputOfParticles(dt);
-            for (const auto &cur_particle : all_particles) {
-                // Apply actual concentration change to particles
-                cur_particle->applyConcentrationChange(dt);
-            }
+            // Exchange concentrations between all particles, initialize particles and apply the changes
+            particle_manager_->updateConcentrations(dt);
         }
 
         // Clean up agents and particles
@@ -81,7 +80,7 @@ void Site::doAgentDynamics(Randomizer *random_generator, const SimulationTime &t
 }
 
 void Site::updateTimeStepSize(SimulationTime &time) {
-    if (particle_manager_->getDiffusionCoefficient() > 500) {
+    if (particle_manager_->allowsSteadyState()) {
         if (particle_manager_->steadyStateReached(time.getCurrentTime()) &&
             !large_timestep_active) {// && abs((systime_min) - round(systime_min)) < 0.000001) {
             // increase the timestep as particle dynamics are not affected anymore
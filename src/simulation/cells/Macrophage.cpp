@@ -35,10 +35,12 @@ unsigned int Macrophage::getCurrentNoOfUptakes() {
 void Macrophage::interactWithMolecules(double timestep) {
 
     // Get the particles for the interaction procedure of AM with molecules
-    const auto &allParticles = site->getParticleManager()->getAllParticles();
+    auto *particleManager = site->getParticleManager();
     std::vector<unsigned int> interactionParticles;
-    site->getParticleManager()->getParticleBalloonList()->setThreshold(10.6);
-    site->getParticleManager()->getParticleBalloonList()->getInteractions(getPosition(), interactionParticles);
+    particleManager->getParticleBalloonList()->setThreshold(10.6);
+    particleManager->getParticleBalloonList()->getInteractions(getPosition(), interactionParticles);
+    // "out of site" particles in reach carry neither chemokine nor gradient, but count for the average gradient
+    const auto outOfSiteParticles = particleManager->countOutOfSiteParticles(getPosition(), 10.6);
 
     // Initialize variables
     double dReceptorsConc = 0, dReceptors = 0, dLRComplexes = 0, dRinternalized = 0;
@@ -49,32 +51,36 @@ void Macrophage::interactWithMolecules(double timestep) {
     // Calculate current receptor-concentration over the cell surface and loop over particles
     double receptorsConc = receptors / (M_PI * radiusAM * radiusAM);
     while (it != interactionParticles.end()) {
-        auto currentParticle = allParticles[(*it)];
+        auto currentParticle = particleManager->getParticle(*it);
 
         // Calculate receptor ligand dynamics
-        double ligandsConc = currentParticle->getConcentration();
+        double ligandsConc = currentParticle.getConcentration();
         dReceptorsConc -= k_blr * ligandsConc * receptorsConc;
 
         // Update receptor and complexes concentration changes
         if (isinf(dReceptorsConc)) dReceptorsConc = 0;
-        dReceptors += dReceptorsConc * currentParticle->getArea();
-        dLRComplexes -= dReceptorsConc * currentParticle->getArea();
+        dReceptors += dReceptorsConc * currentParticle.getArea();
+        dLRComplexes -= dReceptorsConc * currentParticle.getArea();
 
-        // If diffusion constant is very high, only internal AM dynamics considered
+        // If diffusion constant is very high or the steady state is loaded from the library, only internal AM dynamics considered
         // -> no exchange with the environment, profile of concentration is frozen at steady state
-        if (site->getParticleManager()->getDiffusionCoefficient() < 500) {
-            currentParticle->addConcentrationChange(dReceptorsConc * timestep);
+        if (particleManager->getDiffusionCoefficient() < 500 && !particleManager->usesSteadyStateLibrary()) {
+            particle_uptake.emplace_back(currentParticle.getId(), dReceptorsConc * timestep);
         }
 
 
         dReceptorsConc = 0;
-        curGradient = currentParticle->getGradient();
+        curGradient = currentParticle.getGradient();
         curAvgGradient += curGradient;
 
         it++;
     }
 
-    curAvgGradient *= 1.0 / interactionParticles.size(); // 1/(µm²*µm) -> concentration change per micrometer
+    curAvgGradient *= 1.0 / (interactionParticles.size() + outOfSiteParticles); // 1/(µm²*µm) -> concentration change per micrometer
+    // an interpolated gradient does not depend on the number of particles in reach, coarse meshes stay smooth
+    if (particleManager->getMeshInterpolation() != MeshInterpolation::NONE) {
+        curAvgGradient = particleManager->getGradientVector(getPosition(), meshTriangleHint);
+    }
 
     // Compute the current absolute difference in LR number at front and rear of the macrophage
     double dLRdiff = k_blr * 4.0 * radiusAM * radiusAM * radiusAM / (3.0) * receptorsConc * curAvgGradient.getMagnitude() * timestep;
@@ -62,6 +62,7 @@ private:
 
     double radius;
     Coordinate3D cumulativePersistenceGradient;
+    int meshTriangleHint = -1; // triangle of the particle mesh at the last gradient query
 };
 
 #endif    /* MACROPHAGE_H */
@@ -0,0 +1,73 @@
+//  Copyright by Christoph Saffer, Paul Rudolph, Sandra Timme, Marco Blickensdorf, Johannes Pollmächer
+//  Research Group Applied Systems Biology - Head: Prof. Dr. Marc Thilo Figge
+//  https://www.leibniz-hki.de/en/applied-systems-biology.html
+//  HKI-Center for Systems Biology of Infection
+//  Leibniz Institute for Natural Product Research and Infection Biology - Hans Knöll Insitute (HKI)
+//  Adolf-Reichwein-Straße 23, 07745 Jena, Germany
+//
+//  This code is licensed under BSD 2-Clause
+//  See the LICENSE file provided with this code for the full license.
+
+
+#include <cmath>
+
+#include "simulation/diffusion/ActiveSet.h"
+#include "simulation/diffusion/DiffusionMatrix.h"
+
+void ActiveSet::initialize(const DiffusionMatrix &diffusionMatrix,
+                           const std::vector<double> &concentrations,
+                           double concentrationThreshold) {
+    matrix = &diffusionMatrix;
+    threshold = concentrationThreshold;
+    members.assign(diffusionMatrix.getNumberOfRows(), 0);
+    rows.clear();
+    front.clear();
+
+    // "out of site" particles never change, but a fixed concentration still flows into their "in site" neighbours
+    for (unsigned int id = 0; id < concentrations.size(); id++) {
+        if (concentrations[id] != 0) {
+            activate(id);
+            activateNeighbours(id);
+        }
+    }
+}
+
+void ActiveSet::activate(unsigned int id) {
+    if (members[id] || !matrix->isInSite(id)) {
+        return;
+    }
+    members[id] = 1;
+    rows.push_back(id);
+    front.push_back(id);
+}
+
+void ActiveSet::activateAll() {
+    for (unsigned int id = 0; id < members.size(); id++) {
+        activate(id);
+    }
+    // every neighbour that can change is a member now
+    front.clear();
+}
+
+void ActiveSet::activateNeighbours(unsigned int id) {
+    const auto &rowOffsets = matrix->getRowOffsets();
+    const auto &columnIndices = matrix->getColumnIndices();
+    for (auto k = rowOffsets[id]; k < rowOffsets[id + 1]; k++) {
+        activate(columnIndices[k]);
+    }
+}
+
+void ActiveSet::propagate(const std::vector<double> &concentrations) {
+    // the members activated here are checked in the next timestep, the front advances one neighbour per timestep
+    // any concentration flows into the neighbours, so they are activated before a row is settled
+    nextFront.swap(front);
+    front.clear();
+    for (const auto id: nextFront) {
+        if (concentrations[id] != 0) {
+            activateNeighbours(id);
+        }
+        if (std::fabs(concentrations[id]) <= threshold) {
+            front.push_back(id);
+        }
+    }
+}
@@ -0,0 +1,65 @@
+//  Copyright by Christoph Saffer, Paul Rudolph, Sandra Timme, Marco Blickensdorf, Johannes Pollmächer
+//  Research Group Applied Systems Biology - Head: Prof. Dr. Marc Thilo Figge
+//  https://www.leibniz-hki.de/en/applied-systems-biology.html
+//  HKI-Center for Systems Biology of Infection
+//  Leibniz Institute for Natural Product Research and Infection Biology - Hans Knöll Insitute (HKI)
+//  Adolf-Reichwein-Straße 23, 07745 Jena, Germany
+//
+//  This code is licensed under BSD 2-Clause
+//  See the LICENSE file provided with this code for the full license.
+
+
+#ifndef ACTIVESET_H
+#define ACTIVESET_H
+
+#include <cstdint>
+#include <vector>
+
+class DiffusionMatrix;
+
+class ActiveSet {
+public:
+    /// Class for the growing set of "in site" particles that take part in the diffusion (the front of the chemokine)
+    /// A particle outside the set and all its neighbours carry no concentration, so its PSE exchange is zero anyway
+    ActiveSet() = default;
+
+    /*!
+     * Activates all particles with a nonzero concentration and their neighbours
+     * @param diffusionMatrix DiffusionMatrix object that contains the compiled neighbourhood of all particles
+     * @param concentrations vector of Double that contains the current concentrations of all particles
+     * @param threshold Double that contains the concentration above which a particle of the front is settled
+     */
+    void initialize(const DiffusionMatrix &diffusionMatrix, const std::vector<double> &concentrations, double threshold);
+
+    /*!
+     * Adds an "in site" particle to the set, e.g. a secreting particle; "out of site" particles are ignored
+     * @param id unsigned int that contains the id of the particle
+     */
+    void activate(unsigned int id);
+
+    /// Adds all "in site" particles to the set, used after loading a steady state field
+    void activateAll();
+
+    /*!
+     * Activates the neighbours of all particles at the front with a nonzero concentration, settled particles leave the front
+     * @param concentrations vector of Double that contains the current concentrations of all particles
+     */
+    void propagate(const std::vector<double> &concentrations);
+
+    /// Returns the ids of all "in site" particles of the set
+    [[nodiscard]] const std::vector<unsigned int> &getRows() const { return rows; }
+    [[nodiscard]] bool isActive(unsigned int id) const { return members[id] != 0; }
+
+private:
+    void activateNeighbours(unsigned int id);
+
+    const DiffusionMatrix *matrix = nullptr;
+    double threshold = 0;
+    std::vector<std::uint8_t> members;
+    std::vector<unsigned int> rows;
+    // members that are not settled yet, their neighbours are activated again while the concentration stays below the threshold
+    std::vector<unsigned int> front;
+    std::vector<unsigned int> nextFront;
+};
+
+#endif    /* ACTIVESET_H */
@@ -0,0 +1,506 @@
+//  Copyright by Christoph Saffer, Paul Rudolph, Sandra Timme, Marco Blickensdorf, Johannes Pollmächer
+//  Research Group Applied Systems Biology - Head: Prof. Dr. Marc Thilo Figge
+//  https://www.leibniz-hki.de/en/applied-systems-biology.html
+//  HKI-Center for Systems Biology of Infection
+//  Leibniz Institute for Natural Product Research and Infection Biology - Hans Knöll Insitute (HKI)
+//  Adolf-Reichwein-Straße 23, 07745 Jena, Germany
+//
+//  This code is licensed under BSD 2-Clause
+//  See the LICENSE file provided with this code for the full license.
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "simulation/diffusion/DiffusionMatrix.h"
+#include "utils/macros.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define ABM_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+DiffusionMatrix::InstructionSet DiffusionMatrix::detectInstructionSet() {
+#ifdef ABM_X86_SIMD
+    if (__builtin_cpu_supports("avx512f")) {
+        return InstructionSet::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return InstructionSet::AVX2;
+    }
+#endif
+    return InstructionSet::SCALAR;
+}
+
+DiffusionMatrix::Precision DiffusionMatrix::precisionFromString(const std::string &name) {
+    if (name == "double") {
+        return Precision::DOUBLE;
+    }
+    if (name == "single") {
+        return Precision::SINGLE;
+    }
+    ERROR_STDERR("Unknown diffusion precision: " << name);
+    exit(1);
+}
+
+DiffusionMatrix::InstructionSet DiffusionMatrix::instructionSetFromString(const std::string &name) {
+    const auto supported = detectInstructionSet();
+    InstructionSet requested;
+    if (name == "auto") {
+        requested = supported;
+    } else if (name == "scalar") {
+        requested = InstructionSet::SCALAR;
+    } else if (name == "avx2") {
+        requested = InstructionSet::AVX2;
+    } else if (name == "avx512") {
+        requested = InstructionSet::AVX512;
+    } else {
+        ERROR_STDERR("Unknown instruction set: " << name);
+        exit(1);
+    }
+    // never run instructions the CPU does not have
+    if (static_cast<int>(requested) > static_cast<int>(supported)) {
+        SYSTEM_STDOUT("Instruction set " << name << " is not supported by this CPU, using the widest supported one");
+        requested = supported;
+    }
+    return requested;
+}
+
+void DiffusionMatrix::compile(const ParticleStore &particles) {
+    const auto &topology = *particles.topology;
+    const auto numberOfParticles = static_cast<unsigned int>(topology.getNumberOfParticles());
+    // the neighbour lists of the mesh already are in CSR format
+    rowOffsets = topology.getNeighbourOffsets();
+    columnIndices = topology.getNeighbourIds();
+    preFactors = topology.getPreFactorsPSE();
+    ownPreFactors.clear();
+    inSiteRows.clear();
+    inSiteFlags = particles.inSite;
+
+    ownPreFactors.reserve(numberOfParticles);
+    for (unsigned int row = 0; row < numberOfParticles; row++) {
+        // the own prefactor is summed up in neighbour order, exactly like in Particle::diffusePSE
+        double ownPreFactor = 0;
+        for (auto k = rowOffsets[row]; k < rowOffsets[row + 1]; k++) {
+            ownPreFactor += preFactors[k];
+        }
+        ownPreFactors.push_back(ownPreFactor);
+
+        //only "in site" grid points are used for the calculations
+        if (inSiteFlags[row]) {
+            inSiteRows.push_back(row);
+        }
+    }
+    compileSlices();
+
+    singlePreFactors.clear();
+    singleOwnPreFactors.clear();
+    singleConcentrations.clear();
+    if (precision == Precision::SINGLE) {
+        singlePreFactors.assign(preFactors.begin(), preFactors.end());
+        singleOwnPreFactors.assign(numberOfParticles, 0);
+        for (unsigned int row = 0; row < numberOfParticles; row++) {
+            for (auto k = rowOffsets[row]; k < rowOffsets[row + 1]; k++) {
+                singleOwnPreFactors[row] += singlePreFactors[k];
+            }
+        }
+        singleConcentrations.assign(numberOfParticles, 0);
+    }
+}
+
+void DiffusionMatrix::synchronize(const std::vector<double> &concentrations) {
+    if (precision == Precision::SINGLE) {
+        singleConcentrations.assign(concentrations.begin(), concentrations.end());
+    }
+}
+
+void DiffusionMatrix::compileSlices() {
+    sliceOffsets.clear();
+    sliceColumnIndices.clear();
+    slicePreFactors.clear();
+    sliceInSiteMasks.clear();
+
+    // only complete slices are stored, the remaining rows are handled by the scalar kernel
+    const auto numberOfSlices = static_cast<unsigned int>(getNumberOfRows() / sliceHeight);
+    sliceOffsets.push_back(0);
+    for (unsigned int slice = 0; slice < numberOfSlices; slice++) {
+        const auto firstRow = slice * sliceHeight;
+        unsigned int width = 0;
+        std::uint8_t mask = 0;
+        for (unsigned int lane = 0; lane < sliceHeight; lane++) {
+            const auto row = firstRow + lane;
+            width = std::max(width, rowOffsets[row + 1] - rowOffsets[row]);
+            if (inSiteFlags[row]) {
+                mask |= static_cast<std::uint8_t>(1u << lane);
+            }
+        }
+        for (unsigned int k = 0; k < width; k++) {
+            for (unsigned int lane = 0; lane < sliceHeight; lane++) {
+                const auto row = firstRow + lane;
+                const auto entry = rowOffsets[row] + k;
+                if (entry < rowOffsets[row + 1]) {
+                    sliceColumnIndices.push_back(static_cast<int>(columnIndices[entry]));
+                    slicePreFactors.push_back(preFactors[entry]);
+                } else {
+                    // padding adds conc * 0 to the sum, which leaves it unchanged
+                    sliceColumnIndices.push_back(static_cast<int>(row));
+                    slicePreFactors.push_back(0.0);
+                }
+            }
+        }
+        sliceOffsets.push_back(static_cast<unsigned int>(sliceColumnIndices.size()));
+        sliceInSiteMasks.push_back(mask);
+    }
+}
+
+void DiffusionMatrix::multiply(const std::vector<double> &concentrations,
+                               std::vector<double> &changes,
+                               double timestep) const {
+    multiplyRows(inSiteRows, concentrations, changes, timestep);
+}
+
+void DiffusionMatrix::multiplyRows(const std::vector<unsigned int> &rows,
+                                   const std::vector<double> &concentrations,
+                                   std::vector<double> &changes,
+                                   double timestep) const {
+    double *change = changes.data();
+    const auto numberOfRows = static_cast<int>(rows.size());
+    if (precision == Precision::SINGLE) {
+        // float * float is exact in double, only the storage of the operands is rounded
+        const float *conc = singleConcentrations.data();
+#pragma omp parallel for num_threads(numberOfThreads) schedule(static) if(numberOfThreads > 1)
+        for (int i = 0; i < numberOfRows; i++) {
+            const auto row = rows[i];
+            double concChangeDiffusion = 0;
+            for (auto k = rowOffsets[row]; k < rowOffsets[row + 1]; k++) {
+                concChangeDiffusion += static_cast<double>(conc[columnIndices[k]]) * singlePreFactors[k];
+            }
+            concChangeDiffusion -= static_cast<double>(conc[row]) * singleOwnPreFactors[row];
+            concChangeDiffusion *= timestep;
+            change[row] += concChangeDiffusion;
+        }
+        return;
+    }
+    const double *conc = concentrations.data();
+    // every row only writes its own change, so the result does not depend on the number of threads
+#pragma omp parallel for num_threads(numberOfThreads) schedule(static) if(numberOfThreads > 1)
+    for (int i = 0; i < numberOfRows; i++) {
+        const auto row = rows[i];
+        double concChangeDiffusion = 0;
+        for (auto k = rowOffsets[row]; k < rowOffsets[row + 1]; k++) {
+            concChangeDiffusion += conc[columnIndices[k]] * preFactors[k];
+        }
+        concChangeDiffusion -= conc[row] * ownPreFactors[row];
+        concChangeDiffusion *= timestep;
+        change[row] += concChangeDiffusion;
+    }
+}
+
+void DiffusionMatrix::multiplySpecies(const std::vector<double> &concentrations,
+                                      std::vector<double> &changes,
+                                      const std::vector<double> &speciesConcentrations,
+                                      std::vector<double> &speciesChanges,
+                                      const std::vector<double> &dcRatios,
+                                      double timestep) const {
+    const double *conc = concentrations.data();
+    double *change = changes.data();
+    const double *speciesConc = speciesConcentrations.data();
+    double *speciesChange = speciesChanges.data();
+    switch (dcRatios.size()) {
+        case 0:
+            multiplyRows(inSiteRows, concentrations, changes, timestep);
+            break;
+        case 1:
+            multiplySpeciesRows<1>(conc, change, speciesConc, speciesChange, dcRatios.data(), timestep);
+            break;
+        case 2:
+            multiplySpeciesRows<2>(conc, change, speciesConc, speciesChange, dcRatios.data(), timestep);
+            break;
+        case 3:
+            multiplySpeciesRows<3>(conc, change, speciesConc, speciesChange, dcRatios.data(), timestep);
+            break;
+        default:
+            ERROR_STDERR("At most " << maxAdditionalSpecies << " additional species are supported");
+            exit(1);
+    }
+}
+
+template<unsigned int Species>
+void DiffusionMatrix::multiplySpeciesRows(const double *conc, double *change, const double *speciesConc,
+                                          double *speciesChange, const double *dcRatios, double timestep) const {
+    const auto numberOfRows = static_cast<int>(inSiteRows.size());
+#pragma omp parallel for num_threads(numberOfThreads) schedule(static) if(numberOfThreads > 1)
+    for (int i = 0; i < numberOfRows; i++) {
+        const auto row = inSiteRows[i];
+        // the chemokine is accumulated exactly like in multiplyRows(), additional species do not change it
+        double concChangeDiffusion = 0;
+        std::array<double, Species> speciesChangeDiffusion{};
+        for (auto k = rowOffsets[row]; k < rowOffsets[row + 1]; k++) {
+            const auto column = columnIndices[k];
+            const double preFactor = preFactors[k];
+            concChangeDiffusion += conc[column] * preFactor;
+            for (unsigned int s = 0; s < Species; s++) {
+                speciesChangeDiffusion[s] += speciesConc[column * Species + s] * preFactor;
+            }
+        }
+        concChangeDiffusion -= conc[row] * ownPreFactors[row];
+        concChangeDiffusion *= timestep;
+        change[row] += concChangeDiffusion;
+        for (unsigned int s = 0; s < Species; s++) {
+            double changeDiffusion = speciesChangeDiffusion[s] - speciesConc[row * Species + s] * ownPreFactors[row];
+            changeDiffusion *= dcRatios[s];
+            changeDiffusion *= timestep;
+            speciesChange[row * Species + s] += changeDiffusion;
+        }
+    }
+}
+
+void DiffusionMatrix::applySpecies(std::vector<double> &speciesConcentrations,
+                                   std::vector<double> &speciesChanges,
+                                   unsigned int numberOfSpecies) const {
+    const auto numberOfRows = static_cast<int>(inSiteRows.size());
+#pragma omp parallel for num_threads(numberOfThreads) schedule(static) if(numberOfThreads > 1)
+    for (int i = 0; i < numberOfRows; i++) {
+        for (auto index = inSiteRows[i] * numberOfSpecies; index < (inSiteRows[i] + 1) * numberOfSpecies; index++) {
+            speciesConcentrations[index] += speciesChanges[index];
+            speciesChanges[index] = 0;
+        }
+    }
+}
+
+double DiffusionMatrix::apply(std::vector<double> &concentrations,
+                              std::vector<double> &changes,
+                              double time_delta) {
+    return applyRows(inSiteRows, concentrations, changes, time_delta);
+}
+
+double DiffusionMatrix::applyRows(const std::vector<unsigned int> &rows,
+                                  std::vector<double> &concentrations,
+                                  std::vector<double> &changes,
+                                  double time_delta) {
+    double maxChange = 0;
+    const bool single = precision == Precision::SINGLE;
+    const auto numberOfRows = static_cast<int>(rows.size());
+    // the maximum is exact, so the reduction gives the same result for any number of threads
+#pragma omp parallel for num_threads(numberOfThreads) schedule(static) reduction(max:maxChange) if(numberOfThreads > 1)
+    for (int i = 0; i < numberOfRows; i++) {
+        const auto row = rows[i];
+        if (concentrations[row] > 0) {
+            const double relChange = fabs(changes[row] / (concentrations[row] * time_delta));
+            if (relChange > maxChange) {
+                maxChange = relChange;
+            }
+        }
+        concentrations[row] += changes[row];
+        changes[row] = 0;
+        if (single) {
+            singleConcentrations[row] = static_cast<float>(concentrations[row]);
+        }
+    }
+    return maxChange;
+}
+
+double DiffusionMatrix::step(const std::vector<double> &concentrations,
+                             std::vector<double> &nextConcentrations,
+                             std::vector<double> &changes,
+                             const std::vector<double> &secretions,
+                             double timestep,
+                             double time_delta) const {
+    const double *conc = concentrations.data();
+    double *next = nextConcentrations.data();
+    double *change = changes.data();
+    const double *secretion = secretions.data();
+    const auto numberOfSlices = static_cast<unsigned int>(sliceInSiteMasks.size());
+    const auto numberOfBlocks = static_cast<int>((numberOfSlices + slicesPerBlock - 1) / slicesPerBlock);
+    double maxChange = 0;
+    // blocks of slices are independent, the result does not depend on the number of threads
+#pragma omp parallel for num_threads(numberOfThreads) schedule(static) reduction(max:maxChange) if(numberOfThreads > 1)
+    for (int block = 0; block < numberOfBlocks; block++) {
+        const auto firstSlice = static_cast<unsigned int>(block) * slicesPerBlock;
+        const auto lastSlice = std::min(firstSlice + slicesPerBlock, numberOfSlices);
+        double blockMaxChange;
+        switch (instructionSet) {
+            case InstructionSet::AVX512:
+                blockMaxChange = stepAVX512(conc, next, change, secretion, firstSlice, lastSlice, timestep, time_delta);
+                break;
+            case InstructionSet::AVX2:
+                blockMaxChange = stepAVX2(conc, next, change, secretion, firstSlice, lastSlice, timestep, time_delta);
+                break;
+            default:
+                blockMaxChange = stepScalar(conc, next, change, secretion, firstSlice * sliceHeight,
+                                            lastSlice * sliceHeight, timestep, time_delta);
+        }
+        maxChange = std::max(maxChange, blockMaxChange);
+    }
+    // the remaining rows do not fill a complete slice
+    return std::max(maxChange, stepScalar(conc, next, change, secretion, numberOfSlices * sliceHeight,
+                                          static_cast<unsigned int>(getNumberOfRows()), timestep, time_delta));
+}
+
+double DiffusionMatrix::stepScalar(const double *conc,
+                                   double *next,
+                                   double *change,
+                                   const double *secretion,
+                                   unsigned int firstRow,
+                                   unsigned int lastRow,
+                                   double timestep,
+                                   double time_delta) const {
+    double maxChange = 0;
+    for (auto row = firstRow; row < lastRow; row++) {
+        if (!inSiteFlags[row]) {
+            next[row] = conc[row];
+            continue;
+        }
+        double concChangeDiffusion = 0;
+        for (auto k = rowOffsets[row]; k < rowOffsets[row + 1]; k++) {
+            concChangeDiffusion += conc[columnIndices[k]] * preFactors[k];
+        }
+        concChangeDiffusion -= conc[row] * ownPreFactors[row];
+        concChangeDiffusion *= timestep;
+        double concChange = change[row] + concChangeDiffusion;
+        concChange += secretion[row];
+        if (conc[row] > 0) {
+            const double relChange = fabs(concChange / (conc[row] * time_delta));
+            if (relChange > maxChange) {
+                maxChange = relChange;
+            }
+        }
+        next[row] = conc[row] + concChange;
+        change[row] = 0;
+    }
+    return maxChange;
+}
+
+#ifdef ABM_X86_SIMD
+__attribute__((target("avx2")))
+double DiffusionMatrix::stepAVX2(const double *conc,
+                                 double *next,
+                                 double *change,
+                                 const double *secretion,
+                                 unsigned int firstSlice,
+                                 unsigned int lastSlice,
+                                 double timestep,
+                                 double time_delta) const {
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d timestepV = _mm256_set1_pd(timestep);
+    const __m256d timeDeltaV = _mm256_set1_pd(time_delta);
+    const __m256d absMask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+    __m256d maxChangeV = zero;
+
+    for (auto slice = firstSlice; slice < lastSlice; slice++) {
+        const auto width = (sliceOffsets[slice + 1] - sliceOffsets[slice]) / sliceHeight;
+        const int *columns = sliceColumnIndices.data() + sliceOffsets[slice];
+        const double *factors = slicePreFactors.data() + sliceOffsets[slice];
+        const std::uint8_t mask = sliceInSiteMasks[slice];
+
+        // one slice of eight rows is processed as two halves of four lanes
+        for (unsigned int half = 0; half < 2; half++) {
+            const auto firstRow = slice * sliceHeight + half * 4;
+            const auto laneMask = static_cast<unsigned int>(mask >> (half * 4));
+            const __m256d inSite = _mm256_castsi256_pd(_mm256_set_epi64x(-static_cast<long long>((laneMask >> 3) & 1u),
+                                                                         -static_cast<long long>((laneMask >> 2) & 1u),
+                                                                         -static_cast<long long>((laneMask >> 1) & 1u),
+                                                                         -static_cast<long long>(laneMask & 1u)));
+            __m256d concChangeDiffusion = zero;
+            for (unsigned int k = 0; k < width; k++) {
+                const __m128i index = _mm_loadu_si128(
+                        reinterpret_cast<const __m128i *>(columns + k * sliceHeight + half * 4));
+                const __m256d neighbourConc = _mm256_i32gather_pd(conc, index, 8);
+                const __m256d factor = _mm256_loadu_pd(factors + k * sliceHeight + half * 4);
+                concChangeDiffusion = _mm256_add_pd(concChangeDiffusion, _mm256_mul_pd(neighbourConc, factor));
+            }
+            const __m256d ownConc = _mm256_loadu_pd(conc + firstRow);
+            const __m256d ownFactor = _mm256_loadu_pd(ownPreFactors.data() + firstRow);
+            concChangeDiffusion = _mm256_sub_pd(concChangeDiffusion, _mm256_mul_pd(ownConc, ownFactor));
+            concChangeDiffusion = _mm256_mul_pd(concChangeDiffusion, timestepV);
+            const __m256d accumulated = _mm256_loadu_pd(change + firstRow);
+            __m256d concChange = _mm256_add_pd(accumulated, concChangeDiffusion);
+            concChange = _mm256_add_pd(concChange, _mm256_loadu_pd(secretion + firstRow));
+
+            const __m256d positive = _mm256_and_pd(inSite, _mm256_cmp_pd(ownConc, zero, _CMP_GT_OQ));
+            const __m256d relChange = _mm256_and_pd(
+                    absMask, _mm256_div_pd(concChange, _mm256_mul_pd(ownConc, timeDeltaV)));
+            maxChangeV = _mm256_max_pd(maxChangeV, _mm256_blendv_pd(zero, relChange, positive));
+
+            _mm256_storeu_pd(next + firstRow,
+                             _mm256_blendv_pd(ownConc, _mm256_add_pd(ownConc, concChange), inSite));
+            _mm256_storeu_pd(change + firstRow, _mm256_blendv_pd(accumulated, zero, inSite));
+        }
+    }
+
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, maxChangeV);
+    return *std::max_element(lanes, lanes + 4);
+}
+
+__attribute__((target("avx512f")))
+double DiffusionMatrix::stepAVX512(const double *conc,
+                                   double *next,
+                                   double *change,
+                                   const double *secretion,
+                                   unsigned int firstSlice,
+                                   unsigned int lastSlice,
+                                   double timestep,
+                                   double time_delta) const {
+    const __m512d zero = _mm512_setzero_pd();
+    const __m512d timestepV = _mm512_set1_pd(timestep);
+    const __m512d timeDeltaV = _mm512_set1_pd(time_delta);
+    __m512d maxChangeV = zero;
+
+    for (auto slice = firstSlice; slice < lastSlice; slice++) {
+        const auto width = (sliceOffsets[slice + 1] - sliceOffsets[slice]) / sliceHeight;
+        const int *columns = sliceColumnIndices.data() + sliceOffsets[slice];
+        const double *factors = slicePreFactors.data() + sliceOffsets[slice];
+        const __mmask8 inSite = sliceInSiteMasks[slice];
+        const auto firstRow = slice * sliceHeight;
+
+        __m512d concChangeDiffusion = zero;
+        for (unsigned int k = 0; k < width; k++) {
+            const __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(columns + k * sliceHeight));
+            const __m512d neighbourConc = _mm512_i32gather_pd(index, conc, 8);
+            const __m512d factor = _mm512_loadu_pd(factors + k * sliceHeight);
+            concChangeDiffusion = _mm512_add_pd(concChangeDiffusion, _mm512_mul_pd(neighbourConc, factor));
+        }
+        const __m512d ownConc = _mm512_loadu_pd(conc + firstRow);
+        const __m512d ownFactor = _mm512_loadu_pd(ownPreFactors.data() + firstRow);
+        concChangeDiffusion = _mm512_sub_pd(concChangeDiffusion, _mm512_mul_pd(ownConc, ownFactor));
+        concChangeDiffusion = _mm512_mul_pd(concChangeDiffusion, timestepV);
+        const __m512d accumulated = _mm512_loadu_pd(change + firstRow);
+        __m512d concChange = _mm512_add_pd(accumulated, concChangeDiffusion);
+        concChange = _mm512_add_pd(concChange, _mm512_loadu_pd(secretion + firstRow));
+
+        const __mmask8 positive = _mm512_mask_cmp_pd_mask(inSite, ownConc, zero, _CMP_GT_OQ);
+        const __m512d relChange = _mm512_abs_pd(_mm512_div_pd(concChange, _mm512_mul_pd(ownConc, timeDeltaV)));
+        maxChangeV = _mm512_mask_max_pd(maxChangeV, positive, maxChangeV, relChange);
+
+        _mm512_storeu_pd(next + firstRow, _mm512_mask_add_pd(ownConc, inSite, ownConc, concChange));
+        _mm512_storeu_pd(change + firstRow, _mm512_mask_blend_pd(inSite, accumulated, zero));
+    }
+
+    return _mm512_reduce_max_pd(maxChangeV);
+}
+#else
+double DiffusionMatrix::stepAVX2(const double *conc,
+                                 double *next,
+                                 double *change,
+                                 const double *secretion,
+                                 unsigned int firstSlice,
+                                 unsigned int lastSlice,
+                                 double timestep,
+                                 double time_delta) const {
+    return stepScalar(conc, next, change, secretion, firstSlice * sliceHeight, lastSlice * sliceHeight,
+                      timestep, time_delta);
+}
+
+double DiffusionMatrix::stepAVX512(const double *conc,
+                                   double *next,
+                                   double *change,
+                                   const double *secretion,
+                                   unsigned int firstSlice,
+                                   unsigned int lastSlice,
+                                   double timestep,
+                                   double time_delta) const {
+    return stepScalar(conc, next, change, secretion, firstSlice * sliceHeight, lastSlice * sliceHeight,
+                      timestep, time_delta);
+}
+#endif
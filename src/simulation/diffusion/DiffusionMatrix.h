@@ -0,0 +1,189 @@
+//  Copyright by Christoph Saffer, Paul Rudolph, Sandra Timme, Marco Blickensdorf, Johannes Pollmächer
+//  Research Group Applied Systems Biology - Head: Prof. Dr. Marc Thilo Figge
+//  https://www.leibniz-hki.de/en/applied-systems-biology.html
+//  HKI-Center for Systems Biology of Infection
+//  Leibniz Institute for Natural Product Research and Infection Biology - Hans Knöll Insitute (HKI)
+//  Adolf-Reichwein-Straße 23, 07745 Jena, Germany
+//
+//  This code is licensed under BSD 2-Clause
+//  See the LICENSE file provided with this code for the full license.
+
+#ifndef DIFFUSIONMATRIX_H
+#define DIFFUSIONMATRIX_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "simulation/ParticleStore.h"
+
+class DiffusionMatrix {
+public:
+    /// Class for the Particle Strength Exchange (PSE) operator of the particle mesh in compressed sparse row (CSR) format
+    /// Additionally holds a sliced ELLPACK copy (slices of eight rows, padded with zero prefactors) for SIMD kernels
+    DiffusionMatrix() = default;
+
+    enum class InstructionSet {
+        SCALAR,
+        AVX2,
+        AVX512
+    };
+
+    /// Returns the widest instruction set that is supported by the current CPU
+    static InstructionSet detectInstructionSet();
+
+    enum class Precision {
+        DOUBLE,
+        SINGLE // float32 prefactors and a float32 copy of the field for the exchange, accumulated in double
+    };
+
+    /*!
+     * Parses a precision from a String ("double" or "single")
+     * @param name String that contains the name of the precision
+     * @return Precision that is used by multiply() and apply()
+     */
+    static Precision precisionFromString(const std::string &name);
+
+    /*!
+     * Parses an instruction set from a String ("auto", "scalar", "avx2" or "avx512")
+     * @param name String that contains the name of the instruction set
+     * @return InstructionSet that is used by step()
+     */
+    static InstructionSet instructionSetFromString(const std::string &name);
+
+    /*!
+     * Compiles the PSE operator from the particle mesh, the "in site" flags have to be set before
+     * @param particles ParticleStore object that contains the mesh and the "in site" flags of all particles
+     */
+    void compile(const ParticleStore &particles);
+
+    /*!
+     * Adds the PSE concentration exchange of one timestep to the concentration changes (sparse matrix-vector product)
+     * @param concentrations vector of Double that contains the current concentrations of all particles
+     * @param changes vector of Double that contains the accumulated concentration changes of all particles
+     * @param timestep Double that contains timestep
+     */
+    void multiply(const std::vector<double> &concentrations, std::vector<double> &changes, double timestep) const;
+
+    /*!
+     * Applies the accumulated concentration changes of all "in site" particles and resets them
+     * @param concentrations vector of Double that contains the current concentrations of all particles
+     * @param changes vector of Double that contains the accumulated concentration changes of all particles
+     * @param time_delta Double that contains timestep
+     * @return Double that contains the maximal relative concentration change
+     */
+    double apply(std::vector<double> &concentrations, std::vector<double> &changes, double time_delta);
+
+    /// multiply() restricted to the given "in site" rows (the active set of the diffusion)
+    void multiplyRows(const std::vector<unsigned int> &rows,
+                      const std::vector<double> &concentrations,
+                      std::vector<double> &changes,
+                      double timestep) const;
+
+    /*!
+     * multiply() for the chemokine and all additional species in one traversal of the operator
+     * The prefactors are proportional to dc, each additional species scales them by its dc relative to the chemokine
+     * @param concentrations vector of Double that contains the current concentrations of all particles
+     * @param changes vector of Double that contains the accumulated concentration changes of all particles
+     * @param speciesConcentrations vector of Double that contains the additional species, interleaved per particle
+     * @param speciesChanges vector of Double that contains the accumulated changes of the additional species
+     * @param dcRatios vector of Double that contains the dc of each additional species divided by the dc of the chemokine
+     * @param timestep Double that contains timestep
+     */
+    void multiplySpecies(const std::vector<double> &concentrations,
+                         std::vector<double> &changes,
+                         const std::vector<double> &speciesConcentrations,
+                         std::vector<double> &speciesChanges,
+                         const std::vector<double> &dcRatios,
+                         double timestep) const;
+
+    /// Applies the accumulated changes of the additional species of all "in site" particles and resets them
+    void applySpecies(std::vector<double> &speciesConcentrations,
+                      std::vector<double> &speciesChanges,
+                      unsigned int numberOfSpecies) const;
+
+    /// apply() restricted to the given "in site" rows (the active set of the diffusion)
+    double applyRows(const std::vector<unsigned int> &rows,
+                     std::vector<double> &concentrations,
+                     std::vector<double> &changes,
+                     double time_delta);
+
+    /*!
+     * Copies the field into the single precision copy, required after the concentrations were changed without apply()
+     * @param concentrations vector of Double that contains the current concentrations of all particles
+     */
+    void synchronize(const std::vector<double> &concentrations);
+
+    /*!
+     * Fused timestep: secretion, PSE exchange and application of all changes in one pass over memory
+     * Results are written to nextConcentrations, "out of site" particles are copied unchanged (in-site mask)
+     * @param concentrations vector of Double that contains the current concentrations of all particles
+     * @param nextConcentrations vector of Double that receives the concentrations after the timestep
+     * @param changes vector of Double that contains the accumulated changes (uptake), reset to zero
+     * @param secretions vector of Double that contains the secreted concentration per particle and timestep
+     * @param timestep Double that contains timestep
+     * @param time_delta Double that contains timestep (used for the relative change)
+     * @return Double that contains the maximal relative concentration change
+     */
+    double step(const std::vector<double> &concentrations,
+                std::vector<double> &nextConcentrations,
+                std::vector<double> &changes,
+                const std::vector<double> &secretions,
+                double timestep,
+                double time_delta) const;
+
+    void setInstructionSet(InstructionSet set) { instructionSet = set; }
+    void setNumberOfThreads(int threads) { numberOfThreads = threads; }
+    /// Has to be set before compile()
+    void setPrecision(Precision p) { precision = p; }
+    [[nodiscard]] Precision getPrecision() const { return precision; }
+    [[nodiscard]] InstructionSet getInstructionSet() const { return instructionSet; }
+    [[nodiscard]] int getNumberOfThreads() const { return numberOfThreads; }
+    [[nodiscard]] size_t getNumberOfRows() const { return ownPreFactors.size(); }
+    [[nodiscard]] size_t getNumberOfNonZeros() const { return columnIndices.size(); }
+    [[nodiscard]] const std::vector<unsigned int> &getRowOffsets() const { return rowOffsets; }
+    [[nodiscard]] const std::vector<unsigned int> &getColumnIndices() const { return columnIndices; }
+    [[nodiscard]] bool isInSite(unsigned int row) const { return inSiteFlags[row] != 0; }
+
+    static constexpr unsigned int sliceHeight = 8;
+    // width of the per-particle species vector of multiplySpecies(), small enough for the accumulators to stay in registers
+    static constexpr unsigned int maxAdditionalSpecies = 3;
+    // slices that are processed together by one thread of step()
+    static constexpr unsigned int slicesPerBlock = 32;
+
+private:
+    void compileSlices();
+    template<unsigned int Species>
+    void multiplySpeciesRows(const double *conc, double *change, const double *speciesConc, double *speciesChange,
+                             const double *dcRatios, double timestep) const;
+    double stepScalar(const double *conc, double *next, double *change, const double *secretion,
+                      unsigned int firstRow, unsigned int lastRow, double timestep, double time_delta) const;
+    double stepAVX2(const double *conc, double *next, double *change, const double *secretion,
+                    unsigned int firstSlice, unsigned int lastSlice, double timestep, double time_delta) const;
+    double stepAVX512(const double *conc, double *next, double *change, const double *secretion,
+                      unsigned int firstSlice, unsigned int lastSlice, double timestep, double time_delta) const;
+
+    std::vector<unsigned int> rowOffsets;
+    std::vector<unsigned int> columnIndices;
+    std::vector<double> preFactors;
+    std::vector<double> ownPreFactors;
+    std::vector<unsigned int> inSiteRows;
+    std::vector<std::uint8_t> inSiteFlags;
+
+    // single precision: 4 instead of 8 bytes per prefactor and gathered concentration in the exchange
+    Precision precision = Precision::DOUBLE;
+    std::vector<float> singlePreFactors;
+    std::vector<double> singleOwnPreFactors; // sums of the rounded prefactors, a uniform field stays unchanged
+    std::vector<float> singleConcentrations;
+
+    // sliced ELLPACK layout, entry k of lane l in slice s is stored at sliceOffsets[s] + k * sliceHeight + l
+    std::vector<unsigned int> sliceOffsets;
+    std::vector<int> sliceColumnIndices;
+    std::vector<double> slicePreFactors;
+    std::vector<std::uint8_t> sliceInSiteMasks;
+    InstructionSet instructionSet = InstructionSet::SCALAR;
+    int numberOfThreads = 1;
+};
+
+#endif    /* DIFFUSIONMATRIX_H */
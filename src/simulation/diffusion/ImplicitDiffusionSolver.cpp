@@ -0,0 +1,191 @@
+//  Copyright by Christoph Saffer, Paul Rudolph, Sandra Timme, Marco Blickensdorf, Johannes Pollmächer
+//  Research Group Applied Systems Biology - Head: Prof. Dr. Marc Thilo Figge
+//  https://www.leibniz-hki.de/en/applied-systems-biology.html
+//  HKI-Center for Systems Biology of Infection
+//  Leibniz Institute for Natural Product Research and Infection Biology - Hans Knöll Insitute (HKI)
+//  Adolf-Reichwein-Straße 23, 07745 Jena, Germany
+//
+//  This code is licensed under BSD 2-Clause
+//  See the LICENSE file provided with this code for the full license.
+
+#include <cmath>
+
+#include "simulation/diffusion/ImplicitDiffusionSolver.h"
+#include "utils/macros.h"
+
+namespace {
+    double dot(const std::vector<double> &v, const std::vector<double> &w) {
+        double sum = 0;
+        for (size_t i = 0; i < v.size(); i++) {
+            sum += v[i] * w[i];
+        }
+        return sum;
+    }
+}
+
+ImplicitDiffusionSolver::Scheme ImplicitDiffusionSolver::schemeFromString(const std::string &name) {
+    if (name == "backward_euler") {
+        return Scheme::BACKWARD_EULER;
+    }
+    if (name == "crank_nicolson") {
+        return Scheme::CRANK_NICOLSON;
+    }
+    ERROR_STDERR("Unknown implicit diffusion scheme: " << name);
+    exit(1);
+}
+
+void ImplicitDiffusionSolver::compile(const ParticleStore &particles) {
+    const auto &topology = *particles.topology;
+    rows.clear();
+    areas.clear();
+    diagonalWeights.clear();
+    innerOffsets.assign(1, 0);
+    innerColumns.clear();
+    innerWeights.clear();
+    boundaryOffsets.assign(1, 0);
+    boundaryColumns.clear();
+    boundaryWeights.clear();
+
+    // only "in site" grid points are unknowns of the linear system
+    std::vector<int> localIndex(topology.getNumberOfParticles(), -1);
+    for (unsigned int id = 0; id < topology.getNumberOfParticles(); id++) {
+        if (particles.inSite[id]) {
+            localIndex[id] = static_cast<int>(rows.size());
+            rows.push_back(id);
+        }
+    }
+
+    for (const auto row: rows) {
+        const auto &neighbourIds = topology.getNeighbourIds();
+        const auto &preFactorsPSE = topology.getPreFactorsPSE();
+        const double area = topology.getAreas()[row];
+
+        // area * dc * contact / (distance * area) is symmetric in both particles
+        double ownPreFactor = 0;
+        for (auto i = topology.getNeighbourOffsets()[row]; i < topology.getNeighbourOffsets()[row + 1]; i++) {
+            const auto neighbourId = neighbourIds[i];
+            if (localIndex[neighbourId] >= 0) {
+                innerColumns.push_back(static_cast<unsigned int>(localIndex[neighbourId]));
+                innerWeights.push_back(area * preFactorsPSE[i]);
+            } else {
+                boundaryColumns.push_back(neighbourId);
+                boundaryWeights.push_back(area * preFactorsPSE[i]);
+            }
+            ownPreFactor += preFactorsPSE[i];
+        }
+        areas.push_back(area);
+        diagonalWeights.push_back(area * ownPreFactor);
+        innerOffsets.push_back(static_cast<unsigned int>(innerColumns.size()));
+        boundaryOffsets.push_back(static_cast<unsigned int>(boundaryColumns.size()));
+    }
+
+    const auto numberOfUnknowns = rows.size();
+    for (auto *v: {&x, &b, &r, &z, &p, &q}) {
+        v->assign(numberOfUnknowns, 0);
+    }
+}
+
+void ImplicitDiffusionSolver::multiply(const std::vector<double> &v,
+                                       std::vector<double> &result,
+                                       double areaFactor,
+                                       double thetaTimestep) const {
+    // (areaFactor * A + theta * dt * L) v, where A contains the areas and L the area weighted PSE operator
+    for (size_t i = 0; i < rows.size(); i++) {
+        double exchange = diagonalWeights[i] * v[i];
+        for (auto k = innerOffsets[i]; k < innerOffsets[i + 1]; k++) {
+            exchange -= innerWeights[k] * v[innerColumns[k]];
+        }
+        result[i] = areaFactor * areas[i] * v[i] + thetaTimestep * exchange;
+    }
+}
+
+unsigned int ImplicitDiffusionSolver::conjugateGradient(double areaFactor, double thetaTimestep) {
+    // Jacobi preconditioned conjugate gradient for b and the initial guess in x
+    const auto numberOfUnknowns = rows.size();
+    multiply(x, q, areaFactor, thetaTimestep);
+    for (size_t i = 0; i < numberOfUnknowns; i++) {
+        r[i] = b[i] - q[i];
+        z[i] = r[i] / (areaFactor * areas[i] + thetaTimestep * diagonalWeights[i]);
+        p[i] = z[i];
+    }
+    double rz = dot(r, z);
+    const double threshold = tolerance * std::sqrt(dot(b, b));
+    const auto maxIterations = static_cast<unsigned int>(10 * numberOfUnknowns + 10);
+    unsigned int iteration = 0;
+    while (std::sqrt(dot(r, r)) > threshold && iteration < maxIterations) {
+        multiply(p, q, areaFactor, thetaTimestep);
+        const double alpha = rz / dot(p, q);
+        for (size_t i = 0; i < numberOfUnknowns; i++) {
+            x[i] += alpha * p[i];
+            r[i] -= alpha * q[i];
+            z[i] = r[i] / (areaFactor * areas[i] + thetaTimestep * diagonalWeights[i]);
+        }
+        const double rzNew = dot(r, z);
+        const double beta = rzNew / rz;
+        for (size_t i = 0; i < numberOfUnknowns; i++) {
+            p[i] = z[i] + beta * p[i];
+        }
+        rz = rzNew;
+        iteration++;
+    }
+    if (iteration == maxIterations) {
+        ERROR_STDERR("Conjugate gradient did not converge after " << iteration << " iterations");
+    }
+    return iteration;
+}
+
+double ImplicitDiffusionSolver::solve(std::vector<double> &concentrations,
+                                      std::vector<double> &changes,
+                                      double timestep,
+                                      double time_delta) {
+    const double theta = (scheme == Scheme::BACKWARD_EULER) ? 1.0 : 0.5;
+    const double thetaTimestep = theta * timestep;
+    const double explicitTimestep = (1.0 - theta) * timestep;
+    const auto numberOfUnknowns = rows.size();
+
+    // right hand side: explicit part of the exchange, accumulated changes and the fixed "out of site" neighbours
+    for (size_t i = 0; i < numberOfUnknowns; i++) {
+        const double conc = concentrations[rows[i]];
+        double exchange = 0;
+        for (auto k = innerOffsets[i]; k < innerOffsets[i + 1]; k++) {
+            exchange += innerWeights[k] * concentrations[rows[innerColumns[k]]];
+        }
+        double boundary = 0;
+        for (auto k = boundaryOffsets[i]; k < boundaryOffsets[i + 1]; k++) {
+            boundary += boundaryWeights[k] * concentrations[boundaryColumns[k]];
+        }
+        exchange += boundary - diagonalWeights[i] * conc;
+        b[i] = areas[i] * (conc + changes[rows[i]]) + explicitTimestep * exchange + thetaTimestep * boundary;
+        x[i] = conc + changes[rows[i]];
+    }
+
+    // starting from the concentrations plus the accumulated changes
+    lastNumberOfIterations = conjugateGradient(1.0, thetaTimestep);
+
+    double maxChange = 0;
+    for (size_t i = 0; i < numberOfUnknowns; i++) {
+        const auto row = rows[i];
+        if (concentrations[row] > 0) {
+            const double relChange = fabs((x[i] - concentrations[row]) / (concentrations[row] * time_delta));
+            if (relChange > maxChange) {
+                maxChange = relChange;
+            }
+        }
+        concentrations[row] = x[i];
+        changes[row] = 0;
+    }
+    return maxChange;
+}
+
+void ImplicitDiffusionSolver::solveSteadyState(const std::vector<double> &sources, std::vector<double> &field) {
+    // L c = A s with all "out of site" particles at zero concentration (absorbing)
+    for (size_t i = 0; i < rows.size(); i++) {
+        b[i] = areas[i] * sources[rows[i]];
+        x[i] = 0;
+    }
+    lastNumberOfIterations = conjugateGradient(0.0, 1.0);
+    field.assign(sources.size(), 0);
+    for (size_t i = 0; i < rows.size(); i++) {
+        field[rows[i]] = x[i];
+    }
+}
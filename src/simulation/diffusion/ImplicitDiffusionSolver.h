@@ -0,0 +1,91 @@
+//  Copyright by Christoph Saffer, Paul Rudolph, Sandra Timme, Marco Blickensdorf, Johannes Pollmächer
+//  Research Group Applied Systems Biology - Head: Prof. Dr. Marc Thilo Figge
+//  https://www.leibniz-hki.de/en/applied-systems-biology.html
+//  HKI-Center for Systems Biology of Infection
+//  Leibniz Institute for Natural Product Research and Infection Biology - Hans Knöll Insitute (HKI)
+//  Adolf-Reichwein-Straße 23, 07745 Jena, Germany
+//
+//  This code is licensed under BSD 2-Clause
+//  See the LICENSE file provided with this code for the full license.
+
+#ifndef IMPLICITDIFFUSIONSOLVER_H
+#define IMPLICITDIFFUSIONSOLVER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "simulation/ParticleStore.h"
+
+class ImplicitDiffusionSolver {
+public:
+    /// Class for unconditionally stable (theta-scheme) PSE diffusion, solved with a Jacobi preconditioned conjugate gradient
+    /// The system is multiplied by the particle areas, which makes it symmetric positive definite
+    ImplicitDiffusionSolver() = default;
+
+    enum class Scheme {
+        BACKWARD_EULER, // theta = 1, first order, no oscillations for large timesteps
+        CRANK_NICOLSON // theta = 0.5, second order
+    };
+
+    /*!
+     * Parses a scheme from a String ("backward_euler" or "crank_nicolson")
+     * @param name String that contains the name of the scheme
+     * @return Scheme that is used by solve()
+     */
+    static Scheme schemeFromString(const std::string &name);
+
+    /*!
+     * Compiles the area weighted PSE operator of all "in site" particles, "out of site" particles are fixed boundary values
+     * @param particles ParticleStore object that contains the mesh and the "in site" flags of all particles
+     */
+    void compile(const ParticleStore &particles);
+
+    /*!
+     * Performs one implicit timestep including the accumulated secretion and uptake and resets them
+     * @param concentrations vector of Double that contains the current concentrations of all particles
+     * @param changes vector of Double that contains the accumulated concentration changes of all particles
+     * @param timestep Double that contains timestep
+     * @param time_delta Double that contains timestep (used for the relative change)
+     * @return Double that contains the maximal relative concentration change
+     */
+    double solve(std::vector<double> &concentrations, std::vector<double> &changes, double timestep, double time_delta);
+
+    /*!
+     * Computes the steady state of the PSE diffusion for constant sources and absorbing "out of site" particles
+     * @param sources vector of Double that contains the secreted concentration per time unit of all particles
+     * @param field vector of Double that receives the steady state concentrations of all particles
+     */
+    void solveSteadyState(const std::vector<double> &sources, std::vector<double> &field);
+
+    void setScheme(Scheme s) { scheme = s; }
+    void setTolerance(double tol) { tolerance = tol; }
+    [[nodiscard]] Scheme getScheme() const { return scheme; }
+    [[nodiscard]] unsigned int getLastNumberOfIterations() const { return lastNumberOfIterations; }
+    [[nodiscard]] size_t getNumberOfUnknowns() const { return rows.size(); }
+
+private:
+    void multiply(const std::vector<double> &x, std::vector<double> &result, double areaFactor, double thetaTimestep) const;
+    unsigned int conjugateGradient(double areaFactor, double thetaTimestep);
+
+    std::vector<unsigned int> rows; // particle id of each unknown
+    std::vector<double> areas;
+    std::vector<double> diagonalWeights; // area * sum of all PSE prefactors of the row
+
+    // area weighted prefactors to "in site" neighbours (local indices) and to fixed "out of site" neighbours (particle ids)
+    std::vector<unsigned int> innerOffsets;
+    std::vector<unsigned int> innerColumns;
+    std::vector<double> innerWeights;
+    std::vector<unsigned int> boundaryOffsets;
+    std::vector<unsigned int> boundaryColumns;
+    std::vector<double> boundaryWeights;
+
+    // work vectors of the conjugate gradient
+    std::vector<double> x, b, r, z, p, q;
+
+    Scheme scheme = Scheme::CRANK_NICOLSON;
+    double tolerance = 1e-10;
+    unsigned int lastNumberOfIterations = 0;
+};
+
+#endif    /* IMPLICITDIFFUSIONSOLVER_H */
@@ -0,0 +1,77 @@
+//  Copyright by Christoph Saffer, Paul Rudolph, Sandra Timme, Marco Blickensdorf, Johannes Pollmächer
+//  Research Group Applied Systems Biology - Head: Prof. Dr. Marc Thilo Figge
+//  https://www.leibniz-hki.de/en/applied-systems-biology.html
+//  HKI-Center for Systems Biology of Infection
+//  Leibniz Institute for Natural Product Research and Infection Biology - Hans Knöll Insitute (HKI)
+//  Adolf-Reichwein-Straße 23, 07745 Jena, Germany
+//
+//  This code is licensed under BSD 2-Clause
+//  See the LICENSE file provided with this code for the full license.
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+#include <boost/filesystem.hpp>
+
+#include "simulation/diffusion/SteadyStateLibrary.h"
+#include "utils/macros.h"
+
+namespace {
+    // file layout: magic, number of particles (uint64), field (double per particle)
+    constexpr char fieldFileMagic[8] = {'A', 'B', 'M', 'S', 'S', 'F', '1', '\0'};
+    constexpr size_t fieldHeaderSize = sizeof(fieldFileMagic) + sizeof(std::uint64_t);
+}
+
+void SteadyStateLibrary::setDirectory(const std::string &dir) {
+    directory = dir;
+    boost::filesystem::create_directories(directory);
+}
+
+bool SteadyStateLibrary::mapField(const std::string &file, size_t numberOfParticles) {
+    if (!boost::filesystem::exists(file) ||
+        boost::filesystem::file_size(file) != fieldHeaderSize + numberOfParticles * sizeof(double)) {
+        return false;
+    }
+    auto mapped = std::make_unique<MappedField>();
+    mapped->file = boost::interprocess::file_mapping(file.c_str(), boost::interprocess::read_only);
+    mapped->region = boost::interprocess::mapped_region(mapped->file, boost::interprocess::read_only);
+    const auto *header = static_cast<const char *>(mapped->region.get_address());
+    std::uint64_t storedParticles;
+    std::memcpy(&storedParticles, header + sizeof(fieldFileMagic), sizeof(storedParticles));
+    if (std::memcmp(header, fieldFileMagic, sizeof(fieldFileMagic)) != 0 || storedParticles != numberOfParticles) {
+        return false;
+    }
+    mappedFields[file] = std::move(mapped);
+    return true;
+}
+
+const double *SteadyStateLibrary::getField(const std::string &key,
+                                           size_t numberOfParticles,
+                                           const std::function<void(std::vector<double> &)> &compute) {
+    const auto file = boost::filesystem::path(directory).append(key + ".ssf").string();
+    if (mappedFields.find(file) == mappedFields.end() && !mapField(file, numberOfParticles)) {
+        DEBUG_STDOUT("Computing steady state field " << file);
+        std::vector<double> field;
+        compute(field);
+
+        // runs in parallel may compute the same field, the rename makes the file appear complete or not at all
+        const auto tmpFile = boost::filesystem::path(directory).append(
+                boost::filesystem::unique_path(key + "-%%%%-%%%%.tmp").string()).string();
+        {
+            std::ofstream out(tmpFile, std::ios::binary);
+            const auto storedParticles = static_cast<std::uint64_t>(numberOfParticles);
+            out.write(fieldFileMagic, sizeof(fieldFileMagic));
+            out.write(reinterpret_cast<const char *>(&storedParticles), sizeof(storedParticles));
+            out.write(reinterpret_cast<const char *>(field.data()),
+                      static_cast<std::streamsize>(numberOfParticles * sizeof(double)));
+        }
+        boost::filesystem::rename(tmpFile, file);
+        if (!mapField(file, numberOfParticles)) {
+            ERROR_STDERR("Could not map steady state field " << file);
+            exit(1);
+        }
+    }
+    const auto *region = static_cast<const char *>(mappedFields[file]->region.get_address());
+    return reinterpret_cast<const double *>(region + fieldHeaderSize);
+}
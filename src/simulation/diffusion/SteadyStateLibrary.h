@@ -0,0 +1,59 @@
+//  Copyright by Christoph Saffer, Paul Rudolph, Sandra Timme, Marco Blickensdorf, Johannes Pollmächer
+//  Research Group Applied Systems Biology - Head: Prof. Dr. Marc Thilo Figge
+//  https://www.leibniz-hki.de/en/applied-systems-biology.html
+//  HKI-Center for Systems Biology of Infection
+//  Leibniz Institute for Natural Product Research and Infection Biology - Hans Knöll Insitute (HKI)
+//  Adolf-Reichwein-Straße 23, 07745 Jena, Germany
+//
+//  This code is licensed under BSD 2-Clause
+//  See the LICENSE file provided with this code for the full license.
+
+#ifndef STEADYSTATELIBRARY_H
+#define STEADYSTATELIBRARY_H
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+class SteadyStateLibrary {
+public:
+    /// Class for an on-disk cache of steady state chemokine fields, one file per secreting AEC, memory-mapped once computed
+    SteadyStateLibrary() = default;
+
+    /*!
+     * Activates the library
+     * @param dir String that contains the directory of the field files (created if it does not exist)
+     */
+    void setDirectory(const std::string &dir);
+
+    /*!
+     * Returns the steady state field for a key, the field is computed and written to disk if it is not cached yet
+     * @param key String that identifies the field (mesh, AEC, dc, secretion and secreting particles)
+     * @param numberOfParticles unsigned int that contains the length of the field
+     * @param compute function that computes the field if it is not cached yet
+     * @return pointer to numberOfParticles Doubles, valid as long as the library exists
+     */
+    const double *getField(const std::string &key,
+                           size_t numberOfParticles,
+                           const std::function<void(std::vector<double> &)> &compute);
+
+    [[nodiscard]] bool isActive() const { return !directory.empty(); }
+    [[nodiscard]] const std::string &getDirectory() const { return directory; }
+
+private:
+    bool mapField(const std::string &file, size_t numberOfParticles);
+
+    struct MappedField {
+        boost::interprocess::file_mapping file;
+        boost::interprocess::mapped_region region;
+    };
+    std::string directory;
+    std::map<std::string, std::unique_ptr<MappedField>> mappedFields;
+};
+
+#endif    /* STEADYSTATELIBRARY_H */
@@ -46,55 +46,60 @@ void StaticBalloonList::initialGridCreation() {
     gridSize[1] = ny;
     gridSize[2] = nz;
 
-    //create the vectors for the representation of grid points
-    for (unsigned int i = 0; i < nx; i++) {
-        std::vector<std::vector<std::vector<unsigned int> > > currXVector;
-
-        for (unsigned int j = 0; j < ny; j++) {
-            std::vector<std::vector<unsigned int> > currYVector;
-
-            for (unsigned int k = 0; k < nz; k++) {
-                std::vector<unsigned int> currZVector;
-                currYVector.push_back(currZVector);
-            }
-            currXVector.push_back(currYVector);
-        }
-        balloonList.push_back(currXVector);
-    }
+    //one start offset per grid point (and the end of the last one), all cells are empty
+    cellStarts.assign(static_cast<size_t>(nx) * ny * nz + 1, 0);
+    cellObjects.clear();
+    pendingObjects.clear();
 }
 
 void StaticBalloonList::addCoordinateWithId(Coordinate3D input, unsigned int id) {
 
-    if (objectAllocator.find(id) == objectAllocator.end()) {
-
-        int u, v, w;
-        Coordinate3D pos = input;
-
-        u = (int) round((pos.x - lowerPoint.x) / gridConstant);
-        v = (int) round((pos.y - lowerPoint.y) / gridConstant);
-        w = (int) round((pos.z - lowerPoint.z) / gridConstant);
-
-        if (u >= gridSize[0] || v >= gridSize[1] || w >= gridSize[2] ||
-            u < 0 || v < 0 || w < 0) {
-            ERROR_STDERR("sphere's position is out of balloonlist-boundary area. "
-                         "Position:" <<
-                                     pos.x);
-            exit(1);
-        } else {
-            balloonList[u][v][w].push_back(id);
-            coordinateAllocator[id] = input;
-        }
+    int u, v, w;
+    Coordinate3D pos = input;
+
+    u = (int) round((pos.x - lowerPoint.x) / gridConstant);
+    v = (int) round((pos.y - lowerPoint.y) / gridConstant);
+    w = (int) round((pos.z - lowerPoint.z) / gridConstant);
+
+    if (u >= gridSize[0] || v >= gridSize[1] || w >= gridSize[2] ||
+        u < 0 || v < 0 || w < 0) {
+        ERROR_STDERR("sphere's position is out of balloonlist-boundary area. "
+                     "Position:" <<
+                                 pos.x);
+        exit(1);
+    } else {
+        pendingObjects.push_back({input, id, static_cast<unsigned int>((u * gridSize[1] + v) * gridSize[2] + w)});
     }
 
 }
 
-void StaticBalloonList::getInteractions(Coordinate3D myPos, std::vector<unsigned int> &neighbours) {
+void StaticBalloonList::sortObjects() {
+    if (pendingObjects.empty()) {
+        return;
+    }
+    // stable counting sort by cell, within a cell the sorted objects stay in front of the new ones
+    cellObjects.insert(cellObjects.end(), pendingObjects.begin(), pendingObjects.end());
+    pendingObjects.clear();
+    std::fill(cellStarts.begin(), cellStarts.end(), 0);
+    for (const auto &object: cellObjects) {
+        cellStarts[object.cell + 1]++;
+    }
+    for (size_t c = 1; c < cellStarts.size(); c++) {
+        cellStarts[c] += cellStarts[c - 1];
+    }
+    std::vector<unsigned int> nextSlot(cellStarts.begin(), cellStarts.end() - 1);
+    std::vector<GridObject> sortedObjects(cellObjects.size());
+    for (const auto &object: cellObjects) {
+        sortedObjects[nextSlot[object.cell]++] = object;
+    }
+    cellObjects.swap(sortedObjects);
+}
 
-    std::vector<unsigned int>::iterator itIds;
+template<typename Visitor>
+void StaticBalloonList::visitObjectsInReach(const Coordinate3D &pos, Visitor visit) {
+    sortObjects();
 
     int u, v, w;
-    Coordinate3D pos = myPos;
-
     u = round((pos.x - lowerPoint.x) / gridConstant);
     v = round((pos.y - lowerPoint.y) / gridConstant);
     w = round((pos.z - lowerPoint.z) / gridConstant);
@@ -102,69 +107,41 @@ void StaticBalloonList::getInteractions(Coordinate3D myPos, std::vector<unsigned
     int nHSize;
     nHSize = (int) ceil(threshold / gridConstant);
 
-    for (int i = u - nHSize; i <= u + nHSize; i++) {
-        if (i < gridSize[0] && i >= 0) {
-            for (int j = v - nHSize; j <= v + nHSize; j++) {
-                if (j < gridSize[1] && j >= 0) {
-                    for (int k = w - nHSize; k <= w + nHSize; k++) {
-                        if (k < gridSize[2] && k >= 0) {
-                            itIds = balloonList[i][j][k].begin();
-                            while (itIds != balloonList[i][j][k].end()) {
-                                unsigned int idPN = *itIds;
-                                double distance = pos.calculateEuclidianDistance(coordinateAllocator[idPN]);
-                                if (distance < threshold) {
-                                    neighbours.push_back(idPN);
-                                }
-                                itIds++;
-                            }
-                        }
-                    }
-                }
+    // the cells of one (i, j) column are consecutive, so their objects form one contiguous range
+    const int firstK = std::max(0, w - nHSize), lastK = std::min(gridSize[2] - 1, w + nHSize);
+    if (firstK > lastK) {
+        return;
+    }
+    for (int i = std::max(0, u - nHSize); i <= std::min(gridSize[0] - 1, u + nHSize); i++) {
+        for (int j = std::max(0, v - nHSize); j <= std::min(gridSize[1] - 1, v + nHSize); j++) {
+            const auto column = (i * gridSize[1] + j) * gridSize[2];
+            const auto last = cellStarts[column + lastK + 1];
+            for (auto o = cellStarts[column + firstK]; o < last; o++) {
+                visit(cellObjects[o]);
             }
         }
     }
+}
 
+void StaticBalloonList::getInteractions(Coordinate3D myPos, std::vector<unsigned int> &neighbours) {
+    visitObjectsInReach(myPos, [&](const GridObject &object) {
+        if (myPos.calculateEuclidianDistance(object.position) < threshold) {
+            neighbours.push_back(object.id);
+        }
+    });
 }
 
 unsigned int StaticBalloonList::getClosestObjectIndex(Coordinate3D myPos) {
-    std::vector<unsigned int>::iterator itIds;
-
-    int u, v, w;
-    Coordinate3D pos = myPos;
-
-    u = round((pos.x - lowerPoint.x) / gridConstant);
-    v = round((pos.y - lowerPoint.y) / gridConstant);
-    w = round((pos.z - lowerPoint.z) / gridConstant);
-
-    int nHSize;
-    nHSize = (int) ceil(threshold / gridConstant);
     double minDistance = 1000;
     unsigned int closestObjectIndex = 999999;
-
-    for (int i = u - nHSize; i <= u + nHSize; i++) {
-        if (i < gridSize[0] && i >= 0) {
-            for (int j = v - nHSize; j <= v + nHSize; j++) {
-                if (j < gridSize[1] && j >= 0) {
-                    for (int k = w - nHSize; k <= w + nHSize; k++) {
-                        if (k < gridSize[2] && k >= 0) {
-                            itIds = balloonList[i][j][k].begin();
-                            while (itIds != balloonList[i][j][k].end()) {
-                                unsigned int idPN = *itIds;
-                                double distance = pos.calculateEuclidianDistance(coordinateAllocator[idPN]);
-                                if (distance < minDistance) {
-                                    minDistance = distance;
-                                    closestObjectIndex = idPN;
-                                }
-                                itIds++;
-                            }
-
-                        }
-                    }
-                }
-            }
+    visitObjectsInReach(myPos, [&](const GridObject &object) {
+        double distance = myPos.calculateEuclidianDistance(object.position);
+        if (distance < minDistance) {
+            minDistance = distance;
+            closestObjectIndex = object.id;
         }
-    }
-    if (closestObjectIndex == 99999) {
+    });
+    if (closestObjectIndex == 999999) {
         INFO_STDOUT("warning: no closest neighbour found!");
     }
     return closestObjectIndex;
@@ -172,49 +149,15 @@ unsigned int StaticBalloonList::getClosestObjectIndex(Coordinate3D myPos) {
 
 void StaticBalloonList::getClosestObjectIndices(Coordinate3D myPos, std::vector<unsigned int> &neighbourList,
                                                 unsigned int closestXParticles) {
-    std::vector<unsigned int>::iterator itIds;
-    std::vector<std::pair<double, unsigned int> > distancesOfIndices;
-
-    int u, v, w;
-    Coordinate3D pos = myPos;
-
-    u = round((pos.x - lowerPoint.x) / gridConstant);
-    v = round((pos.y - lowerPoint.y) / gridConstant);
-    w = round((pos.z - lowerPoint.z) / gridConstant);
-
-    int nHSize;
-    nHSize = (int) ceil(threshold / gridConstant);
-    double minDistance = 1000;
-    unsigned int closestObjectIndex = 999999;
-
-    for (int i = u - nHSize; i <= u + nHSize; i++) {
-        if (i < gridSize[0] && i >= 0) {
-            for (int j = v - nHSize; j <= v + nHSize; j++) {
-                if (j < gridSize[1] && j >= 0) {
-                    for (int k = w - nHSize; k <= w + nHSize; k++) {
-                        if (k < gridSize[2] && k >= 0) {
-                            itIds = balloonList[i][j][k].begin();
-                            while (itIds != balloonList[i][j][k].end()) {
-                                unsigned int idPN = *itIds;
-                                double distance = pos.calculateEuclidianDistance(coordinateAllocator[idPN]);
-                                std::pair<double, unsigned int> curDistanceOfIdx = std::pair<double, unsigned int>(
-                                        distance, idPN);
-                                distancesOfIndices.push_back(curDistanceOfIdx);
-                                itIds++;
-                            }
-                        }
-                    }
-                }
-            }
-        }
+    distancesOfIndices.clear();
+    visitObjectsInReach(myPos, [&](const GridObject &object) {
+        distancesOfIndices.emplace_back(myPos.calculateEuclidianDistance(object.position), object.id);
+    });
+
+    // only the closest objects have to be in order
+    const auto numberOfInserts = std::min<size_t>(closestXParticles, distancesOfIndices.size());
+    std::partial_sort(distancesOfIndices.begin(), distancesOfIndices.begin() + numberOfInserts, distancesOfIndices.end());
+    for (size_t i = 0; i < numberOfInserts; i++) {
+        neighbourList.push_back(distancesOfIndices[i].second);
     }
-
-    std::sort(distancesOfIndices.begin(), distancesOfIndices.end());
-    std::vector<std::pair<double, unsigned int> >::iterator it = distancesOfIndices.begin();
-    unsigned int curNumberOfInserts = 0;
-    while (it != distancesOfIndices.end() && curNumberOfInserts < closestXParticles) {
-        neighbourList.push_back(it->second);
-        curNumberOfInserts++;
-        it++;
-    }
-}
\ No newline at end of file
+}
@@ -11,14 +11,15 @@
 #ifndef STATICBALLOONLIST_H
 #define    STATICBALLOONLIST_H
 
+#include <utility>
 #include <vector>
-#include <map>
 
 #include "basic/Coordinate3D.h"
 
 class StaticBalloonList {
 public:
   // Class for defining a baloon list as a grid that represents the whole environment for efficient neighbourhood detection of cells.
+  // The objects are static and stored as a flat cell list (counting sort by cell) that is built on the first query.
     StaticBalloonList();
     StaticBalloonList(const StaticBalloonList &orig);
     virtual ~StaticBalloonList();
@@ -31,13 +32,27 @@ public:
                                  unsigned int closestXParticles);
     void addCoordinateWithId(Coordinate3D input, unsigned int id);
     void setThreshold(double thresh) { threshold = thresh; };
+    [[nodiscard]] size_t getNumberOfObjects() const { return cellObjects.size() + pendingObjects.size(); };
 
 private:
+    // object with its coordinate inline, a query reads its neighbourhood from contiguous memory
+    struct GridObject {
+        Coordinate3D position;
+        unsigned int id;
+        unsigned int cell;
+    };
+
+    template<typename Visitor>
+    void visitObjectsInReach(const Coordinate3D &pos, Visitor visit);
+    void sortObjects();
     double gridConstant;
     double threshold;
-    std::vector<std::vector<std::vector<std::vector<unsigned int> > > > balloonList;
-    std::map<unsigned int, int *> objectAllocator;
-    std::map<unsigned int, Coordinate3D> coordinateAllocator;
+    // objects of cell (i, j, k) are cellObjects[cellStarts[c]] to cellObjects[cellStarts[c + 1]] with c = (i * ny + j) * nz + k,
+    // in the order of their insertion
+    std::vector<unsigned int> cellStarts;
+    std::vector<GridObject> cellObjects;
+    std::vector<GridObject> pendingObjects; // added since the last sort
+    std::vector<std::pair<double, unsigned int>> distancesOfIndices; // reused by getClosestObjectIndices()
     Coordinate3D lowerPoint;
     Coordinate3D upperPoint;
     int gridSize[3];
@@ -45,4 +60,3 @@ private:
 };
 
 #endif    /* STATICBALLOONLIST_H */
-
@@ -0,0 +1,92 @@
+//  Copyright by Christoph Saffer, Paul Rudolph, Sandra Timme, Marco Blickensdorf, Johannes Pollmächer
+//  Research Group Applied Systems Biology - Head: Prof. Dr. Marc Thilo Figge
+//  https://www.leibniz-hki.de/en/applied-systems-biology.html
+//  HKI-Center for Systems Biology of Infection
+//  Leibniz Institute for Natural Product Research and Infection Biology - Hans Knöll Insitute (HKI)
+//  Adolf-Reichwein-Straße 23, 07745 Jena, Germany
+//
+//  This code is licensed under BSD 2-Clause
+//  See the LICENSE file provided with this code for the full license.
+
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+
+#include "simulation/neighbourhood/TriangleLocator.h"
+
+void TriangleLocator::build(const std::vector<TRIANGLE3D> &meshTriangles, const std::vector<Coordinate3D> &meshPositions) {
+    triangles = &meshTriangles;
+    positions = &meshPositions;
+    adjacentTriangles.assign(meshTriangles.size(), {-1, -1, -1});
+    vertexTriangles.assign(meshPositions.size(), -1);
+
+    // an edge is shared by (at most) two triangles, it is identified by its two sorted vertex ids
+    std::unordered_map<std::uint64_t, std::pair<int, int>> edges;
+    edges.reserve(3 * meshTriangles.size());
+    for (size_t t = 0; t < meshTriangles.size(); t++) {
+        const auto &ids = meshTriangles[t].neighbourIds;
+        for (int i = 0; i < 3; i++) {
+            vertexTriangles[ids[i]] = static_cast<int>(t);
+            const auto a = std::min(ids[(i + 1) % 3], ids[(i + 2) % 3]);
+            const auto b = std::max(ids[(i + 1) % 3], ids[(i + 2) % 3]);
+            const auto key = (static_cast<std::uint64_t>(a) << 32) | b;
+            auto edge = edges.find(key);
+            if (edge == edges.end()) {
+                edges.emplace(key, std::make_pair(static_cast<int>(t), i));
+            } else {
+                adjacentTriangles[t][i] = edge->second.first;
+                adjacentTriangles[edge->second.first][edge->second.second] = static_cast<int>(t);
+            }
+        }
+    }
+}
+
+int TriangleLocator::locate(const Coordinate3D &position, int startTriangle) const {
+    if (startTriangle < 0 || startTriangle >= static_cast<int>(adjacentTriangles.size())) {
+        return -1;
+    }
+    // rounding errors at the edges must not let the walk oscillate between two triangles
+    constexpr double tolerance = 1e-9;
+    int current = startTriangle;
+    for (size_t step = 0; step < adjacentTriangles.size(); step++) {
+        const auto &ids = (*triangles)[current].neighbourIds;
+        const auto &a = (*positions)[ids[0]];
+        const Coordinate3D ab = (*positions)[ids[1]] - a;
+        const Coordinate3D ac = (*positions)[ids[2]] - a;
+        const Coordinate3D ap = position - a;
+
+        // barycentric coordinates of the projection of the position onto the plane of the triangle
+        const double d00 = ab.scalarProduct(ab);
+        const double d01 = ab.scalarProduct(ac);
+        const double d11 = ac.scalarProduct(ac);
+        const double d20 = ap.scalarProduct(ab);
+        const double d21 = ap.scalarProduct(ac);
+        const double denominator = d00 * d11 - d01 * d01;
+        if (denominator == 0) {
+            return -1;
+        }
+        const double v = (d11 * d20 - d01 * d21) / denominator;
+        const double w = (d00 * d21 - d01 * d20) / denominator;
+        const double barycentric[3] = {1.0 - v - w, v, w};
+
+        // step towards the position, over the edge opposite to the most negative coordinate
+        int vertex = 0;
+        for (int i = 1; i < 3; i++) {
+            if (barycentric[i] < barycentric[vertex]) {
+                vertex = i;
+            }
+        }
+        if (barycentric[vertex] >= -tolerance) {
+            // on a closed surface the projection also hits the triangles on the far side, these are rejected
+            const Coordinate3D normal = ab.crossProduct(ac);
+            const double heightSquared = ap.scalarProduct(normal) * ap.scalarProduct(normal) / normal.scalarProduct(normal);
+            return heightSquared <= std::max(d00, d11) ? current : -1;
+        }
+        current = adjacentTriangles[current][vertex];
+        if (current < 0) {
+            return -1;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,62 @@
+//  Copyright by Christoph Saffer, Paul Rudolph, Sandra Timme, Marco Blickensdorf, Johannes Pollmächer
+//  Research Group Applied Systems Biology - Head: Prof. Dr. Marc Thilo Figge
+//  https://www.leibniz-hki.de/en/applied-systems-biology.html
+//  HKI-Center for Systems Biology of Infection
+//  Leibniz Institute for Natural Product Research and Infection Biology - Hans Knöll Insitute (HKI)
+//  Adolf-Reichwein-Straße 23, 07745 Jena, Germany
+//
+//  This code is licensed under BSD 2-Clause
+//  See the LICENSE file provided with this code for the full license.
+
+
+#ifndef TRIANGLELOCATOR_H
+#define TRIANGLELOCATOR_H
+
+#include <array>
+#include <vector>
+
+#include "basic/Coordinate3D.h"
+
+struct TRIANGLE3D {
+    bool outside;
+    unsigned int neighbourIds[3];
+};
+
+class TriangleLocator {
+public:
+    /// Class for point location on the triangulated particle mesh by walking from triangle to neighbouring triangle
+    /// Queries that start at the triangle of the previous query of a slowly moving agent only take a few steps
+    TriangleLocator() = default;
+
+    /*!
+     * Builds the neighbourhood of the triangles, the triangle on the other side of each edge
+     * @param triangles vector of TRIANGLE3D objects, has to stay valid as long as the locator is used
+     * @param positions vector of Coordinate3D objects that contains the positions of all particles (vertices)
+     */
+    void build(const std::vector<TRIANGLE3D> &triangles, const std::vector<Coordinate3D> &positions);
+
+    /*!
+     * Walks from a start triangle to the triangle that contains the projection of a position
+     * @param position Coordinate3D object that contains the position of interest
+     * @param startTriangle int that contains the index of the first triangle of the walk, usually the last hit of an agent
+     * @return int that contains the index of the triangle, -1 if the walk left the mesh or did not converge
+     */
+    [[nodiscard]] int locate(const Coordinate3D &position, int startTriangle) const;
+
+    /// Returns a triangle that contains the vertex (particle), -1 if the vertex is not part of any triangle
+    [[nodiscard]] int getTriangleOfVertex(unsigned int vertex) const {
+        return vertex < vertexTriangles.size() ? vertexTriangles[vertex] : -1;
+    };
+    [[nodiscard]] const TRIANGLE3D &getTriangle(int triangle) const { return (*triangles)[triangle]; };
+    [[nodiscard]] size_t getNumberOfTriangles() const { return adjacentTriangles.size(); };
+    [[nodiscard]] bool isEmpty() const { return adjacentTriangles.empty(); };
+
+private:
+    const std::vector<TRIANGLE3D> *triangles{};
+    const std::vector<Coordinate3D> *positions{};
+    // triangle on the other side of the edge opposite to vertex i, -1 at the border of the mesh
+    std::vector<std::array<int, 3>> adjacentTriangles;
+    std::vector<int> vertexTriangles;
+};
+
+#endif    /* TRIANGLELOCATOR_H */
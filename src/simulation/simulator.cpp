@@ -12,6 +12,8 @@
 #include <omp.h>
 #include <string>
 
+#include <boost/algorithm/string.hpp>
+
 #include "simulation/simulator.h"
 #include "io/output_handler.h"
 #include "simulation/CellFactory.h"
@@ -27,6 +29,8 @@
 #include "simulation/AgentManager.h"
 #include "simulation/CellStateFactory.h"
 #include "simulation/InteractionStateFactory.h"
+#include "simulation/ParticleMeshGenerator.h"
+#include "simulation/ParticleTopology.h"
 
 int Simulator::consumers = 0;
 
@@ -83,6 +87,11 @@ void Simulator::executeRuns(int runs, int seed, const std::string &output_dir, c
     using timer = std::chrono::steady_clock;
     const auto start = timer::now();
 
+    // Diffusion of each run may use its own nested thread team
+    if (parameters_.site_parameters->particle_manager_parameters.diffusion_threads > 1) {
+        omp_set_max_active_levels(2);
+    }
+
     // Start parallelized for-loop over all runs for one parameter configuration
 #pragma omp parallel for schedule(dynamic)
     for (int current_run = 1; current_run <= runs; ++current_run) {
@@ -136,7 +145,8 @@ std::unique_ptr<Site> Simulator::createSites(int run, Randomizer *random_generat
                                             parameters_.dimensions,
                                             input_dir,
                                             random_generator,
-                                            analyser->generateMeasurement(std::to_string(run)));
+                                            analyser->generateMeasurement(std::to_string(run)),
+                                            getParticleTopology(input_dir));
     }
     if (parameters_.site_parameters->type == "AlveoleSite") {
         return std::make_unique<AlveoleSite>(parameters_.site_parameters.get(),
@@ -144,25 +154,112 @@ std::unique_ptr<Site> Simulator::createSites(int run, Randomizer *random_generat
                                              parameters_.dimensions,
                                              input_dir,
                                              random_generator,
-                                             analyser->generateMeasurement(std::to_string(run)));
+                                             analyser->generateMeasurement(std::to_string(run)),
+                                             getParticleTopology(input_dir));
     }
     ERROR_STDERR("Unknown site with type name: " << parameters_.site_parameters->type);
     return std::unique_ptr<Site>();
 }
 
+std::shared_ptr<const ParticleTopology> Simulator::getParticleTopology(const std::string &input_dir) const {
+    // runs are created in parallel, only the first one loads the mesh
+    std::lock_guard<std::mutex> lock(particle_topology_mutex_);
+    const auto &particle_parameters = parameters_.site_parameters->particle_manager_parameters;
+    const auto ordering = ParticleTopology::orderingFromString(particle_parameters.particle_ordering);
+    if (!particle_topology_ && particle_parameters.number_of_particles > 0) {
+        // other sites generate the mesh on their own sphere in the particle manager
+        if (parameters_.site_parameters->type == "AlveoleSite") {
+            const auto *alveolus = static_cast<const abm::util::SimulationParameters::AlveolusSiteParameter *>(
+                    parameters_.site_parameters.get());
+            particle_topology_ = ParticleTopology::fromMesh(
+                    ParticleMeshGenerator::sphere(particle_parameters.number_of_particles, alveolus->site_radius,
+                                                  alveolus->site_center),
+                    particle_parameters.diffusion_constant, ordering);
+        }
+    } else if (!particle_topology_) {
+        particle_topology_ = ParticleTopology::load(
+                boost::filesystem::path(input_dir).append(particle_parameters.particle_delauney_input_file).string(),
+                particle_parameters.diffusion_constant, ordering);
+    }
+    return particle_topology_;
+}
+
 void Simulator::handleCmdInputArgs(const std::unordered_map<std::string, std::string> &cmd_input_args) {
     // Parameters to be screened or from cmd input
-    // Here: dc, sAEC, nOfM and nOfCon that are specified in parameter_screening option in config_*.json
+    // Here: dc, sAEC, nOfM, nOfCon and the particle and diffusion settings of the keys below that are specified in
+    // parameter_screening option in config_*.json
     for (const auto&[key, value] : cmd_input_args) {
         if ("dc" == key) {
             parameters_.site_parameters->particle_manager_parameters.diffusion_constant = std::stod(value);
             SYSTEM_STDOUT("Set parameter: " << key << " = " << value);
-            updateTimestepForDC(parameters_.site_parameters->particle_manager_parameters.diffusion_constant);
         }
         if ("sAEC" == key) {
             parameters_.site_parameters->particle_manager_parameters.molecule_secretion_per_cell = std::stod(value);
             SYSTEM_STDOUT("Set parameter: " << key << " = " << value);
         }
+        if ("diffusion_backend" == key) {
+            parameters_.site_parameters->particle_manager_parameters.diffusion_backend = value;
+            SYSTEM_STDOUT("Set parameter: " << key << " = " << value);
+        }
+        if ("simd_instruction_set" == key) {
+            parameters_.site_parameters->particle_manager_parameters.simd_instruction_set = value;
+            SYSTEM_STDOUT("Set parameter: " << key << " = " << value);
+        }
+        if ("diffusion_threads" == key) {
+            parameters_.site_parameters->particle_manager_parameters.diffusion_threads = std::stoi(value);
+            SYSTEM_STDOUT("Set parameter: " << key << " = " << value);
+        }
+        if ("diffusion_solver" == key) {
+            parameters_.site_parameters->particle_manager_parameters.diffusion_solver = value;
+            SYSTEM_STDOUT("Set parameter: " << key << " = " << value);
+        }
+        if ("steady_state_detection" == key) {
+            parameters_.site_parameters->particle_manager_parameters.steady_state_detection = value;
+            SYSTEM_STDOUT("Set parameter: " << key << " = " << value);
+        }
+        if ("steady_state_library" == key) {
+            parameters_.site_parameters->particle_manager_parameters.steady_state_library = value;
+            SYSTEM_STDOUT("Set parameter: " << key << " = " << value);
+        }
+        if ("diffusion_active_set" == key) {
+            parameters_.site_parameters->particle_manager_parameters.diffusion_active_set = (value == "true" || value == "1");
+            SYSTEM_STDOUT("Set parameter: " << key << " = " << value);
+        }
+        if ("diffusion_precision" == key) {
+            parameters_.site_parameters->particle_manager_parameters.diffusion_precision = value;
+            SYSTEM_STDOUT("Set parameter: " << key << " = " << value);
+        }
+        if ("particle_ordering" == key) {
+            parameters_.site_parameters->particle_manager_parameters.particle_ordering = value;
+            SYSTEM_STDOUT("Set parameter: " << key << " = " << value);
+        }
+        if ("particles" == key) {
+            parameters_.site_parameters->particle_manager_parameters.number_of_particles = std::stoul(value);
+            SYSTEM_STDOUT("Set parameter: " << key << " = " << value);
+        }
+        if ("mesh_interpolation" == key) {
+            parameters_.site_parameters->particle_manager_parameters.mesh_interpolation = value;
+            SYSTEM_STDOUT("Set parameter: " << key << " = " << value);
+        }
+        if ("additional_species" == key) {
+            // comma separated list of dc:secretion pairs, e.g. "300:6000,600:3000"
+            auto &additional_species = parameters_.site_parameters->particle_manager_parameters.additional_species;
+            additional_species.clear();
+            std::vector<std::string> species;
+            boost::algorithm::split(species, value, boost::is_any_of(","));
+            for (const auto &entry: species) {
+                std::vector<std::string> tokens;
+                boost::algorithm::split(tokens, entry, boost::is_any_of(":"));
+                additional_species.push_back({"species" + std::to_string(additional_species.size() + 1),
+                                              std::stod(tokens.at(0)), std::stod(tokens.at(1))});
+            }
+            SYSTEM_STDOUT("Set parameter: " << key << " = " << value);
+        }
+    }
+    // implicit diffusion is unconditionally stable, the timestep does not depend on dc
+    if (cmd_input_args.count("dc") > 0 &&
+        parameters_.site_parameters->particle_manager_parameters.diffusion_solver == "explicit") {
+        updateTimestepForDC(parameters_.site_parameters->particle_manager_parameters.diffusion_constant);
     }
     for (const auto &agent : parameters_.site_parameters->agent_manager_parameters.agents) {
         if ("Macrophage" == agent->type) {
@@ -11,13 +11,29 @@
 #ifndef SIMULATOR_SIMULATOR_H_
 #define SIMULATOR_SIMULATOR_H_
 
+#include <memory>
+#include <mutex>
+
 #include "utils/io_util.h"
 
 class Site;
+class ParticleTopology;
 class Analyser;
 class Randomizer;
 
-namespace abm::test { std::string test_simulation(const std::string &config); }
+namespace abm::test {
+    std::string test_simulation(const std::string &config,
+                                const std::unordered_map<std::string, std::string> &cmd_input_args);
+    std::vector<double> test_particle_concentrations(const std::string &config,
+                                                     const std::unordered_map<std::string, std::string> &cmd_input_args,
+                                                     double max_time,
+                                                     unsigned int species);
+    double test_site_mean_concentration(const std::string &config,
+                                        const std::unordered_map<std::string, std::string> &cmd_input_args,
+                                        double max_time);
+    double test_steady_state_time(const std::string &config,
+                                  const std::unordered_map<std::string, std::string> &cmd_input_args);
+}
 class Simulator {
 public:
     /// Class for starting simulations
@@ -67,12 +83,31 @@ public:
     void updateTimestepForDC(double dc);
 
     /// Used for integration tests
-    friend std::string abm::test::test_simulation(const std::string &config);
+    friend std::string abm::test::test_simulation(const std::string &config,
+                                                  const std::unordered_map<std::string, std::string> &cmd_input_args);
+    friend std::vector<double> abm::test::test_particle_concentrations(const std::string &config,
+                                                                       const std::unordered_map<std::string, std::string> &cmd_input_args,
+                                                                       double max_time,
+                                                                       unsigned int species);
+    friend double abm::test::test_site_mean_concentration(const std::string &config,
+                                                          const std::unordered_map<std::string, std::string> &cmd_input_args,
+                                                          double max_time);
+    friend double abm::test::test_steady_state_time(const std::string &config,
+                                                    const std::unordered_map<std::string, std::string> &cmd_input_args);
 
 private:
+    /*!
+     * Returns the particle mesh that is shared by all runs, it is loaded by the first run that needs it
+     * @param input_dir String that contains input directory
+     * @return ParticleTopology object
+     */
+    std::shared_ptr<const ParticleTopology> getParticleTopology(const std::string &input_dir) const;
+
     static int consumers;
     std::string config_path_{};
     abm::util::SimulationParameters parameters_{};
+    mutable std::shared_ptr<const ParticleTopology> particle_topology_{};
+    mutable std::mutex particle_topology_mutex_{};
 };
 
 #endif // SIMULATOR_SIMULATOR_H_
@@ -24,7 +24,8 @@ AlveoleSite::AlveoleSite(abm::util::SimulationParameters::SiteParameters *parame
                          unsigned int spatial_dimensions,
                          const std::string &input_dir,
                          Randomizer *random_generator,
-                         std::shared_ptr<InSituMeasurements> measurements) : SphereSite(time_delta,
+                         std::shared_ptr<InSituMeasurements> measurements,
+                         std::shared_ptr<const ParticleTopology> particle_topology) : SphereSite(time_delta,
                                                                                         spatial_dimensions,
                                                                                         random_generator,
                                                                                         std::move(measurements)) {
@@ -76,7 +77,8 @@ AlveoleSite::AlveoleSite(abm::util::SimulationParameters::SiteParameters *parame
 
     // Initialize particles and basic variables
     this->getParticleManager()->setAECCells(alvEpithTypeOne, alvEpithTypeTwo);
-    particle_manager_->initializeParticles(this, parameters->particle_manager_parameters, input_dir);
+    particle_manager_->initializeParticles(this, parameters->particle_manager_parameters, input_dir,
+                                           std::move(particle_topology));
     state_ = 1;
     boundary_input_vector_ = Coordinate3D();
     passiveMovementOn = parameters->passive_movement;
@@ -26,7 +26,8 @@ public:
                 double time_delta,
                 unsigned int spatial_dimensions,
                 const std::string &input_dir,
-                Randomizer *random_generator, std::shared_ptr<InSituMeasurements> measurements);
+                Randomizer *random_generator, std::shared_ptr<InSituMeasurements> measurements,
+                std::shared_ptr<const ParticleTopology> particle_topology = nullptr);
 
     /*!
      * Generates random direction vector on alveoleSite (sphere)
@@ -22,7 +22,8 @@ SphereSite::SphereSite(abm::util::SimulationParameters::SiteParameters *paramete
                        unsigned int spatial_dimensions,
                        const std::string &input_dir,
                        Randomizer *random_generator,
-                       std::shared_ptr<InSituMeasurements> measurements) : Site(time_delta,
+                       std::shared_ptr<InSituMeasurements> measurements,
+                       std::shared_ptr<const ParticleTopology> particle_topology) : Site(time_delta,
                                                                                 spatial_dimensions,
                                                                                 random_generator,
                                                                                 std::move(measurements)) {
@@ -37,7 +38,8 @@ SphereSite::SphereSite(abm::util::SimulationParameters::SiteParameters *paramete
         neighbourhood_locator_->setInteractionCheckInterval(icInterval);
     }
     initializeAgents(parameters->agent_manager_parameters, input_dir, 0, time_delta);
-    particle_manager_->initializeParticles(this, parameters->particle_manager_parameters, input_dir);
+    particle_manager_->initializeParticles(this, parameters->particle_manager_parameters, input_dir,
+                                           std::move(particle_topology));
     passiveMovementOn = parameters->passive_movement;
 
 }
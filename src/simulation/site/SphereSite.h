@@ -17,6 +17,8 @@
 #include "simulation/Site.h"
 #include "basic/Coordinate3D.h"
 
+class ParticleTopology;
+
 class SphereSite : public Site {
 public:
   // Class for spherical class environment
@@ -32,7 +34,8 @@ public:
                unsigned int spatial_dimensions,
                const std::string &input_dir,
                Randomizer *random_generator,
-               std::shared_ptr<InSituMeasurements> measurements);
+               std::shared_ptr<InSituMeasurements> measurements,
+               std::shared_ptr<const ParticleTopology> particle_topology = nullptr);
 
     void includeSiteXMLTagToc(XMLFile *xmlFile) const override;
     void handleBoundaryCross(Agent *, Coordinate3D *, double current_time) final;
@@ -120,6 +120,35 @@ namespace abm::util {
                 site_para->particle_manager_parameters.particle_delauney_input_file = particles->value(
                         "particle_delauney_input_file", "");
                 site_para->particle_manager_parameters.draw_isolines = particles->value("draw_isolines", false);
+                site_para->particle_manager_parameters.diffusion_backend = particles->value("diffusion_backend",
+                                                                                            "particle");
+                site_para->particle_manager_parameters.simd_instruction_set = particles->value(
+                        "simd_instruction_set", "auto");
+                site_para->particle_manager_parameters.diffusion_threads = particles->value("diffusion_threads", 1);
+                site_para->particle_manager_parameters.diffusion_solver = particles->value("diffusion_solver",
+                                                                                           "explicit");
+                site_para->particle_manager_parameters.solver_tolerance = particles->value("solver_tolerance", 1e-10);
+                site_para->particle_manager_parameters.steady_state_detection = particles->value(
+                        "steady_state_detection", "lookup");
+                site_para->particle_manager_parameters.steady_state_tolerance = particles->value(
+                        "steady_state_tolerance", 1e-3);
+                site_para->particle_manager_parameters.steady_state_window = particles->value("steady_state_window", 10);
+                site_para->particle_manager_parameters.steady_state_library = particles->value("steady_state_library",
+                                                                                               "");
+                site_para->particle_manager_parameters.diffusion_active_set = particles->value("diffusion_active_set",
+                                                                                               false);
+                site_para->particle_manager_parameters.active_set_threshold = particles->value("active_set_threshold",
+                                                                                               0.0);
+                site_para->particle_manager_parameters.diffusion_precision = particles->value("diffusion_precision",
+                                                                                              "double");
+                site_para->particle_manager_parameters.particle_ordering = particles->value("particle_ordering", "none");
+                site_para->particle_manager_parameters.number_of_particles = particles->value("number_of_particles", 0u);
+                site_para->particle_manager_parameters.mesh_interpolation = particles->value("mesh_interpolation", "none");
+                for (const auto &species: particles->value("additional_species", json::array())) {
+                    site_para->particle_manager_parameters.additional_species.push_back(
+                            {species.value("name", ""), species.value("diffusion_constant", 0.0),
+                             species.value("molecule_secretion_per_cell", 0.0)});
+                }
             }
 
             // load agent manager
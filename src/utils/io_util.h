@@ -90,11 +90,33 @@ namespace abm::util {
             std::vector<std::pair<std::string, MoleculeInteractionParameters>> molecule_interactions{};
         };
 
+        struct SpeciesParameters {
+            std::string name{};
+            double diffusion_constant{};
+            double molecule_secretion_per_cell{};
+        };
+
         struct ParticleManagerParameters {
             double diffusion_constant{};
             double molecule_secretion_per_cell{};
             bool draw_isolines{};
             std::string particle_delauney_input_file{};
+            unsigned int number_of_particles{}; // generated mesh instead of the particle-delauney input (if > 0)
+            std::string diffusion_backend{};
+            std::string simd_instruction_set{};
+            int diffusion_threads{};
+            std::string diffusion_solver{};
+            double solver_tolerance{};
+            std::string steady_state_detection{};
+            double steady_state_tolerance{};
+            int steady_state_window{};
+            std::string steady_state_library{};
+            bool diffusion_active_set{};
+            double active_set_threshold{};
+            std::string diffusion_precision{};
+            std::string particle_ordering{};
+            std::string mesh_interpolation{};
+            std::vector<SpeciesParameters> additional_species{}; // molecules that diffuse beside the chemokine
         };
 
         struct MacrophageParameters : public AgentParameters {
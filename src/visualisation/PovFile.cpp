@@ -8,6 +8,8 @@
 //  This code is licensed under BSD 2-Clause
 //  See the LICENSE file provided with this code for the full license.
 
+#include <map>
+
 #include "visualisation/PovFile.h"
 #include "utils/io_util.h"
 #include "simulation/Site.h"
@@ -259,6 +261,7 @@ void PovFile::transcribeParticles(const Site &site) {
             int n = curNode.nChildNode();
             double xVal = 0, yVal = 0, zVal = 0;
             std::vector<Coordinate3D> positions, voronois;
+            std::map<unsigned int, Coordinate3D> positionsOfIds; // only the active particles are written
 
             Coordinate3D startIso, endIso;
             double strength;
@@ -271,6 +274,7 @@ void PovFile::transcribeParticles(const Site &site) {
                     Coordinate3D position = InputConfiguration::getCoordinateDataFieldValueByName(&particleNode,
                                                                                                   "position");
                     positions.push_back(position);
+                    positionsOfIds[InputConfiguration::getUIntDataFieldValueByName(&particleNode, "id")] = position;
                 }
 
                 if (nameOfNode == "Voronoi") {
@@ -327,7 +331,7 @@ void PovFile::transcribeParticles(const Site &site) {
                             if (nameOfChild == "Particle") {
                                 unsigned int idN = InputConfiguration::getUIntDataFieldValueByName(
                                         &childInteractionNode, "id");
-                                Coordinate3D positionN = positions[idN];
+                                Coordinate3D positionN = positionsOfIds[idN];
                                 double radiusCyl = 0.13;
                             }
                         }
@@ -42,7 +42,7 @@ Visualizer::Visualizer(const std::string &config_path, const std::string &projec
 void Visualizer::visualizeCurrentConfiguration(const Site &site, const SimulationTime &time, int run,
                                                bool simulation_end) const {
     bool writeout = (0 == time % static_cast<int>(parameters_.output_interval));
-    if (site.getParticleManager()->getDiffusionCoefficient() > 500) {
+    if (site.getParticleManager()->allowsSteadyState()) {
         // In ParticleManager::steadyStateReached - timestep changes during the simulation when a steady state is reached
         // Output interval must be adjusted to generate homogeneous output
         int frames_per_minute = parameters_.output_interval;
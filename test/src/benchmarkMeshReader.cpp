@@ -0,0 +1,50 @@
+//  Copyright by Christoph Saffer, Paul Rudolph, Sandra Timme, Marco Blickensdorf, Johannes Pollmächer
+//  Research Group Applied Systems Biology - Head: Prof. Dr. Marc Thilo Figge
+//  https://www.leibniz-hki.de/en/applied-systems-biology.html
+//  HKI-Center for Systems Biology of Infection
+//  Leibniz Institute for Natural Product Research and Infection Biology - Hans Knöll Insitute (HKI)
+//  Adolf-Reichwein-Straße 23, 07745 Jena, Germany
+//
+//  This code is licensed under BSD 2-Clause
+//  See the LICENSE file provided with this code for the full license.
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include <sys/resource.h>
+#include <boost/filesystem.hpp>
+
+#include "io/ParticleMeshFile.h"
+#include "testMeshes.h"
+
+// Benchmark of the streaming particle mesh reader on a synthetic lattice (a million particles by default), not part of ctest.
+// The input is written and read in separate runs, so the peak memory of a read run only contains the reader.
+int main(int argc, char **argv) {
+    const std::string mode = argc > 1 ? argv[1] : "";
+    if ((mode != "write" && mode != "read") || argc < 3 || argc > 4) {
+        std::cerr << "usage: " << argv[0] << " write <particle-delauney.xml> [<particles per side>]\n"
+                  << "       " << argv[0] << " read <particle-delauney.xml>\n";
+        return 1;
+    }
+    const std::string file = argv[2];
+    if (mode == "write") {
+        const auto side = argc == 4 ? static_cast<unsigned int>(std::stoul(argv[3])) : 1000u;
+        abm::test::writeParticleDelauneyXML(file, abm::test::shuffledMesh(abm::test::latticeMesh(side, side)));
+        std::cout << "Wrote " << side * side << " particles (" << boost::filesystem::file_size(file) / (1 << 20)
+                  << " MiB) to " << file << '\n';
+        return 0;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto mesh = ParticleMeshFile::readXML(file);
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const auto meshBytes = (mesh.positions.size() + mesh.areas.size() + mesh.concentrations.size() + mesh.contactAreas.size()) *
+                           sizeof(double) + (mesh.neighbourOffsets.size() + mesh.neighbourIds.size()) * sizeof(std::uint32_t);
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    std::cout << mesh.areas.size() << " particles from " << boost::filesystem::file_size(file) / (1 << 20) << " MiB in "
+              << elapsed << " s, peak resident memory " << usage.ru_maxrss / 1024 << " MiB for a mesh of "
+              << meshBytes / (1 << 20) << " MiB\n";
+    return 0;
+}
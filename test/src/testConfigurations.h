@@ -12,7 +12,19 @@
 #define TESTCONFIGURATIONS_H
 
 #include <string>
+#include <unordered_map>
+#include <vector>
 namespace abm::test {
-std::string test_simulation(const std::string &config);
+std::string test_simulation(const std::string &config,
+                            const std::unordered_map<std::string, std::string> &cmd_input_args = {});
+std::vector<double> test_particle_concentrations(const std::string &config,
+                                                 const std::unordered_map<std::string, std::string> &cmd_input_args = {},
+                                                 double max_time = -1,
+                                                 unsigned int species = 0);
+double test_site_mean_concentration(const std::string &config,
+                                    const std::unordered_map<std::string, std::string> &cmd_input_args,
+                                    double max_time);
+double test_steady_state_time(const std::string &config,
+                              const std::unordered_map<std::string, std::string> &cmd_input_args = {});
 }
 #endif /* TESTCONFIGURATIONS_H */
@@ -0,0 +1,101 @@
+//  Copyright by Christoph Saffer, Paul Rudolph, Sandra Timme, Marco Blickensdorf, Johannes Pollmächer
+//  Research Group Applied Systems Biology - Head: Prof. Dr. Marc Thilo Figge
+//  https://www.leibniz-hki.de/en/applied-systems-biology.html
+//  HKI-Center for Systems Biology of Infection
+//  Leibniz Institute for Natural Product Research and Infection Biology - Hans Knöll Insitute (HKI)
+//  Adolf-Reichwein-Straße 23, 07745 Jena, Germany
+//
+//  This code is licensed under BSD 2-Clause
+//  See the LICENSE file provided with this code for the full license.
+
+#ifndef ABM_TESTMESHES_H_
+#define ABM_TESTMESHES_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "io/ParticleMeshFile.h"
+
+// synthetic particle meshes of the unit tests and the benchmarks
+namespace abm::test {
+    // planar triangular lattice with rows * columns particles, each square is split by its diagonal
+    inline ParticleMesh latticeMesh(unsigned int rows, unsigned int columns) {
+        ParticleMesh mesh;
+        mesh.neighbourOffsets.push_back(0);
+        for (unsigned int r = 0; r < rows; r++) {
+            for (unsigned int c = 0; c < columns; c++) {
+                mesh.positions.insert(mesh.positions.end(), {static_cast<double>(c), static_cast<double>(r), 0.0});
+                mesh.areas.push_back(1.0);
+                mesh.concentrations.push_back(0.0);
+                const int offsets[6][2] = {{0, 1}, {1, 1}, {1, 0}, {0, -1}, {-1, -1}, {-1, 0}};
+                for (const auto &offset: offsets) {
+                    const int nr = static_cast<int>(r) + offset[0], nc = static_cast<int>(c) + offset[1];
+                    if (nr >= 0 && nr < static_cast<int>(rows) && nc >= 0 && nc < static_cast<int>(columns)) {
+                        mesh.neighbourIds.push_back(static_cast<std::uint32_t>(nr) * columns + nc);
+                        mesh.contactAreas.push_back(1.0);
+                    }
+                }
+                mesh.neighbourOffsets.push_back(static_cast<std::uint32_t>(mesh.neighbourIds.size()));
+            }
+        }
+        return mesh;
+    }
+
+    // the same mesh with randomly permuted ids, like the ids of a mesh file that are scattered over the surface
+    inline ParticleMesh shuffledMesh(const ParticleMesh &mesh) {
+        const auto numberOfParticles = mesh.areas.size();
+        std::vector<std::uint32_t> order(numberOfParticles), newIds(numberOfParticles);
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), std::mt19937(42));
+        for (std::uint32_t i = 0; i < numberOfParticles; i++) {
+            newIds[order[i]] = i;
+        }
+        ParticleMesh shuffled;
+        shuffled.neighbourOffsets.push_back(0);
+        for (const auto old: order) {
+            shuffled.positions.insert(shuffled.positions.end(), mesh.positions.begin() + 3 * old, mesh.positions.begin() + 3 * old + 3);
+            shuffled.areas.push_back(mesh.areas[old]);
+            shuffled.concentrations.push_back(mesh.concentrations[old]);
+            for (auto k = mesh.neighbourOffsets[old]; k < mesh.neighbourOffsets[old + 1]; k++) {
+                shuffled.neighbourIds.push_back(newIds[mesh.neighbourIds[k]]);
+                shuffled.contactAreas.push_back(mesh.contactAreas[k]);
+            }
+            shuffled.neighbourOffsets.push_back(static_cast<std::uint32_t>(shuffled.neighbourIds.size()));
+        }
+        return shuffled;
+    }
+
+    // writes a mesh in the particle-delauney format, the ids of the file are not the positions of the particles
+    inline void writeParticleDelauneyXML(const std::string &file, const ParticleMesh &mesh) {
+        const auto fileId = [](std::uint32_t index) { return 3 * index + 7; };
+        std::ofstream out(file);
+        out << std::setprecision(17) << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<Agent-Based-Framework>\n"
+            << "<Site><DataField name=\"radius\"><Value value=\"1\"/></DataField></Site>\n<!-- <Particle> -->\n<Particles>\n";
+        for (std::uint32_t i = 0; i < mesh.areas.size(); i++) {
+            out << "<Particle><DataField name=\"id\" conversion=\"discrete\" dataType=\"unsigned int\"><Value value=\""
+                << fileId(i) << "\"/></DataField>"
+                << "<DataField name=\"position\" conversion=\"continuous\" dataType=\"double\"><Values xValue=\""
+                << mesh.positions[3 * i] << "\" yValue=\"" << mesh.positions[3 * i + 1] << "\" zValue=\""
+                << mesh.positions[3 * i + 2] << "\"/></DataField>"
+                << "<DataField name=\"concentration\" conversion=\"continuous\" dataType=\"double\"><Value value=\""
+                << mesh.concentrations[i] << "\"/></DataField>"
+                << "<DataField name=\"area\" conversion=\"continuous\" dataType=\"double\"><Value value=\""
+                << mesh.areas[i] << "\"/></DataField>\n<Interactions>";
+            for (auto k = mesh.neighbourOffsets[i]; k < mesh.neighbourOffsets[i + 1]; k++) {
+                out << "<Particle><DataField name=\"id\"><Value value=\"" << fileId(mesh.neighbourIds[k])
+                    << "\"/></DataField><DataField name=\"contact\"><Value value=\"" << mesh.contactAreas[k]
+                    << "\"/></DataField></Particle>";
+            }
+            out << "</Interactions>\n</Particle>\n";
+        }
+        out << "</Particles>\n</Agent-Based-Framework>\n";
+    }
+}
+
+#endif //ABM_TESTMESHES_H_
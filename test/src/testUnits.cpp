@@ -12,13 +12,70 @@
 
 #include "external/doctest/doctest.h"
 
+#include "testMeshes.h"
 #include "testUnits.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <malloc.h>
 #include <memory>
+#include <new>
+#include <numeric>
+#include <random>
 #include <string>
 
 #include "analyser/pair_measurement.h"
 #include "analyser/histogram_measurment.h"
 #include "analyser/InSituMeasurements.h"
+#include "io/ParticleMeshFile.h"
+#include "simulation/Algorithms.h"
+#include "simulation/Particle.h"
+#include "simulation/ParticleMeshGenerator.h"
+#include "simulation/ParticleStore.h"
+#include "simulation/diffusion/ActiveSet.h"
+#include "simulation/diffusion/DiffusionMatrix.h"
+#include "simulation/neighbourhood/StaticBalloonList.h"
+
+#include <boost/filesystem.hpp>
+
+namespace {
+    // counts the heap allocations of the test binary, to check that a code path does not allocate
+    std::atomic<size_t> numberOfAllocations{0};
+    // heap memory that is currently allocated with new and its maximum (reset by the tests that measure it)
+    std::atomic<size_t> heapBytes{0};
+    std::atomic<size_t> peakHeapBytes{0};
+
+    void releaseHeapMemory(void *memory) {
+        if (memory != nullptr) {
+            heapBytes -= malloc_usable_size(memory);
+            std::free(memory);
+        }
+    }
+}
+
+void *operator new(std::size_t size) {
+    numberOfAllocations++;
+    if (void *memory = std::malloc(size == 0 ? 1 : size)) {
+        const auto bytes = heapBytes += malloc_usable_size(memory);
+        auto peak = peakHeapBytes.load();
+        while (bytes > peak && !peakHeapBytes.compare_exchange_weak(peak, bytes)) {}
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept {
+    releaseHeapMemory(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept {
+    releaseHeapMemory(memory);
+}
 
 
 TEST_CASE ("Check Pair Measurements") {
@@ -119,3 +176,525 @@ TEST_CASE("Check distance on spheres") {
     result = 2 * r * M_PI * 0.5;
     CHECK(distance == result);
 }
+
+// ParticleMeshFile.cpp
+TEST_CASE("Check binary particle mesh") {
+    const auto mesh = ParticleMeshFile::readXML("../../input/particle-dist/513particles-delauney.xml");
+    REQUIRE(mesh.areas.size() == 513);
+    REQUIRE(mesh.neighbourOffsets.size() == 514);
+    CHECK(mesh.neighbourOffsets.back() == mesh.neighbourIds.size());
+
+    const auto file = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.mesh");
+    REQUIRE(ParticleMeshFile::write(file.string(), mesh));
+    ParticleMeshFile mapped;
+    REQUIRE(mapped.open(file.string()));
+    REQUIRE(mapped.getNumberOfParticles() == mesh.areas.size());
+    CHECK(mapped.getSourceSize() == boost::filesystem::file_size("../../input/particle-dist/513particles-delauney.xml"));
+    CHECK(std::equal(mesh.positions.begin(), mesh.positions.end(), mapped.getPositions()));
+    CHECK(std::equal(mesh.areas.begin(), mesh.areas.end(), mapped.getAreas()));
+    CHECK(std::equal(mesh.concentrations.begin(), mesh.concentrations.end(), mapped.getConcentrations()));
+    CHECK(std::equal(mesh.neighbourOffsets.begin(), mesh.neighbourOffsets.end(), mapped.getNeighbourOffsets()));
+    CHECK(std::equal(mesh.neighbourIds.begin(), mesh.neighbourIds.end(), mapped.getNeighbourIds()));
+    CHECK(std::equal(mesh.contactAreas.begin(), mesh.contactAreas.end(), mapped.getContactAreas()));
+
+    // the cache is used without its XML input
+    const auto topology = ParticleTopology::load(boost::filesystem::path(file).replace_extension(".xml").string(), 20.0);
+    CHECK(topology->getNumberOfParticles() == mesh.areas.size());
+
+    // a truncated file is rejected instead of being read out of bounds
+    boost::filesystem::resize_file(file, boost::filesystem::file_size(file) - sizeof(double));
+    ParticleMeshFile truncated;
+    CHECK(!truncated.open(file.string()));
+    boost::filesystem::remove(file);
+}
+
+// Particle.cpp
+TEST_CASE("Check allocation free particle diffusion") {
+    ParticleStore particles;
+    particles.topology = ParticleTopology::load("../../input/particle-dist/513particles-delauney.xml", 20.0);
+    const auto numberOfParticles = static_cast<unsigned int>(particles.topology->getNumberOfParticles());
+    REQUIRE(numberOfParticles == 513);
+    particles.concentrations.assign(numberOfParticles, 0);
+    particles.concentrationChanges.assign(numberOfParticles, 0);
+    particles.inSite.assign(numberOfParticles, 1);
+    particles.atBoundary.assign(numberOfParticles, 0);
+    particles.inSiteIds.resize(numberOfParticles);
+    std::iota(particles.inSiteIds.begin(), particles.inSiteIds.end(), 0u);
+    particles.gradients.assign(numberOfParticles, Coordinate3D());
+    for (unsigned int id = 0; id < numberOfParticles; id += 7) {
+        particles.concentrations[id] = 1.0;
+    }
+
+    // the particle phase (exchange, application and gradients of all particles) does not allocate
+    const int numberOfSteps = 10;
+    double sumOfGradients = 0;
+    const auto allocationsBefore = numberOfAllocations.load();
+    for (int step = 0; step < numberOfSteps; step++) {
+        for (unsigned int id = 0; id < numberOfParticles; id++) {
+            Particle(&particles, id).doAllActionsForTimestep(0.001);
+        }
+        for (unsigned int id = 0; id < numberOfParticles; id++) {
+            Particle(&particles, id).applyConcentrationChange(0.001);
+        }
+        particles.gradientsOutdated = true;
+        for (unsigned int id = 0; id < numberOfParticles; id++) {
+            Particle particle(&particles, id);
+            sumOfGradients += particle.getGradient().getMagnitude() + particle.getGradientStrength();
+        }
+    }
+    CHECK(numberOfAllocations.load() == allocationsBefore);
+    CHECK(sumOfGradients > 0);
+}
+
+// DiffusionMatrix.cpp
+TEST_CASE("Check batched species diffusion") {
+    ParticleStore particles;
+    particles.topology = ParticleTopology::load("../../input/particle-dist/513particles-delauney.xml", 20.0);
+    const auto numberOfParticles = static_cast<unsigned int>(particles.topology->getNumberOfParticles());
+    const unsigned int numberOfSpecies = DiffusionMatrix::maxAdditionalSpecies;
+    particles.concentrations.assign(numberOfParticles, 0);
+    particles.inSite.assign(numberOfParticles, 1);
+    particles.inSite[0] = 0;
+    particles.numberOfAdditionalSpecies = numberOfSpecies;
+    particles.speciesConcentrations.assign(numberOfParticles * numberOfSpecies, 0);
+    for (unsigned int id = 0; id < numberOfParticles; id++) {
+        particles.concentrations[id] = particles.topology->getPositions()[id].x;
+        for (unsigned int s = 0; s < numberOfSpecies; s++) {
+            particles.speciesConcentrations[id * numberOfSpecies + s] = (id * (s + 3)) % 11;
+        }
+    }
+    DiffusionMatrix matrix;
+    matrix.compile(particles);
+    const std::vector<double> dcRatios = {1.0, 0.5, 0.25};
+
+    // the batched pass gives the same chemokine as multiply() and each species as a pass with its own dc
+    std::vector<double> changes(numberOfParticles, 0), speciesChanges(numberOfParticles * numberOfSpecies, 0);
+    matrix.multiplySpecies(particles.concentrations, changes, particles.speciesConcentrations, speciesChanges, dcRatios, 0.01);
+    std::vector<double> reference(numberOfParticles, 0);
+    matrix.multiply(particles.concentrations, reference, 0.01);
+    CHECK(changes == reference);
+    for (unsigned int s = 0; s < numberOfSpecies; s++) {
+        std::vector<double> species(numberOfParticles), speciesReference(numberOfParticles, 0);
+        for (unsigned int id = 0; id < numberOfParticles; id++) {
+            species[id] = particles.speciesConcentrations[id * numberOfSpecies + s];
+        }
+        matrix.multiply(species, speciesReference, 0.01 * dcRatios[s]);
+        for (unsigned int id = 0; id < numberOfParticles; id++) {
+            REQUIRE(speciesChanges[id * numberOfSpecies + s] == doctest::Approx(speciesReference[id]).epsilon(1e-12));
+        }
+    }
+    matrix.applySpecies(particles.speciesConcentrations, speciesChanges, numberOfSpecies);
+    CHECK(std::all_of(speciesChanges.begin(), speciesChanges.end(), [](double change) { return change == 0; }));
+}
+
+// ActiveSet.cpp
+TEST_CASE("Check mass conservation of the active set diffusion") {
+    ParticleStore particles;
+    particles.topology = ParticleTopology::load("../../input/particle-dist/513particles-delauney.xml", 20.0);
+    const auto numberOfParticles = static_cast<unsigned int>(particles.topology->getNumberOfParticles());
+    const auto &areas = particles.topology->getAreas();
+    particles.inSite.assign(numberOfParticles, 1);
+    DiffusionMatrix matrix;
+    matrix.compile(particles);
+
+    // a few particles below the threshold, one secreting and one taking up particle, steps like concentrationStep()
+    std::vector<double> concentrations(numberOfParticles, 0), changes(numberOfParticles, 0);
+    for (unsigned int id = 100; id < 105; id++) {
+        concentrations[id] = 1e-4;
+    }
+    const double threshold = 0.01, timestep = 0.01;
+    const unsigned int secretingId = 0, uptakeId = 102;
+    ActiveSet activeSet;
+    activeSet.initialize(matrix, concentrations, threshold);
+    const auto mass = [&]() {
+        double sum = 0;
+        for (unsigned int id = 0; id < numberOfParticles; id++) {
+            sum += concentrations[id] * areas[id];
+        }
+        return sum;
+    };
+    const double initialMass = mass();
+    double secreted = 0, takenUp = 0;
+    for (int step = 0; step < 5; step++) {
+        const double uptake = -0.5 * concentrations[uptakeId] * timestep;
+        changes[uptakeId] += uptake;
+        if (uptake != 0) {
+            activeSet.activate(uptakeId);
+        }
+        takenUp -= uptake * areas[uptakeId];
+        matrix.multiplyRows(activeSet.getRows(), concentrations, changes, timestep);
+        changes[secretingId] += timestep;
+        secreted += timestep * areas[secretingId];
+        activeSet.activate(secretingId);
+        matrix.applyRows(activeSet.getRows(), concentrations, changes, timestep);
+        activeSet.propagate(concentrations);
+    }
+    CHECK(takenUp > 0);
+    CHECK(activeSet.getRows().size() < numberOfParticles);
+    CHECK(mass() - initialMass == doctest::Approx(secreted - takenUp).epsilon(1e-10));
+    // no change is left behind for a particle outside the set
+    CHECK(std::all_of(changes.begin(), changes.end(), [](double change) { return change == 0; }));
+}
+
+// ParticleTopology.cpp
+TEST_CASE("Check cached particle gradients") {
+    ParticleStore particles;
+    particles.topology = ParticleTopology::load("../../input/particle-dist/513particles-delauney.xml", 20.0);
+    const auto numberOfParticles = static_cast<unsigned int>(particles.topology->getNumberOfParticles());
+    particles.concentrations.assign(numberOfParticles, 0);
+    particles.inSite.assign(numberOfParticles, 1);
+    particles.gradients.assign(numberOfParticles, Coordinate3D());
+    for (unsigned int id = 0; id < numberOfParticles; id++) {
+        particles.concentrations[id] = particles.topology->getPositions()[id].x;
+    }
+    particles.inSite[0] = 0;
+    for (unsigned int id = 1; id < numberOfParticles; id++) {
+        particles.inSiteIds.push_back(id);
+    }
+
+    // the cached operator gives the same result as the sum over the neighbour list
+    const auto directGradient = [&](unsigned int id) {
+        Coordinate3D gradient = Coordinate3D();
+        const auto neighbourList = Particle(&particles, id).getParticleNeighbourList();
+        const auto neighbourIds = neighbourList.getNeighbourIds();
+        const auto preFactorsGradient = neighbourList.getPreFactorsGradient();
+        for (size_t k = 0; k < neighbourIds.size(); k++) {
+            Coordinate3D curGradient{particles.topology->getPositions()[neighbourIds[k]] - particles.topology->getPositions()[id]};
+            curGradient *= 0.5 * preFactorsGradient[k] * (particles.concentrations[neighbourIds[k]] - particles.concentrations[id]);
+            gradient += curGradient;
+        }
+        return gradient;
+    };
+    CHECK(Particle(&particles, 0).getGradient().getMagnitude() == 0);
+    for (unsigned int id = 1; id < numberOfParticles; id++) {
+        const auto cached = Particle(&particles, id).getGradient();
+        const auto direct = directGradient(id);
+        REQUIRE(cached.x == direct.x);
+        REQUIRE(cached.y == direct.y);
+        REQUIRE(cached.z == direct.z);
+    }
+
+    // the cache is kept until it is marked as outdated
+    const auto before = Particle(&particles, 1).getGradient();
+    particles.concentrations.assign(numberOfParticles, 1.0);
+    CHECK(Particle(&particles, 1).getGradient().x == before.x);
+    particles.gradientsOutdated = true;
+    CHECK(Particle(&particles, 1).getGradient().getMagnitude() == 0);
+}
+
+// ParticleMeshFile.cpp
+TEST_CASE("Check streaming particle mesh reader") {
+    const auto mesh = abm::test::shuffledMesh(abm::test::latticeMesh(200, 150));
+    const auto file = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.xml");
+    abm::test::writeParticleDelauneyXML(file.string(), mesh);
+
+    const auto heapBefore = heapBytes.load();
+    peakHeapBytes = heapBefore;
+    const auto read = ParticleMeshFile::readXML(file.string());
+    const auto peak = peakHeapBytes.load() - heapBefore;
+    const auto meshBytes = (read.positions.size() + read.areas.size() + read.concentrations.size() + read.contactAreas.size()) *
+                           sizeof(double) + (read.neighbourOffsets.size() + read.neighbourIds.size()) * sizeof(std::uint32_t);
+    const auto fileBytes = boost::filesystem::file_size(file);
+    boost::filesystem::remove(file);
+
+    CHECK(read.positions == mesh.positions);
+    CHECK(read.areas == mesh.areas);
+    CHECK(read.concentrations == mesh.concentrations);
+    CHECK(read.neighbourOffsets == mesh.neighbourOffsets);
+    CHECK(read.neighbourIds == mesh.neighbourIds);
+    CHECK(read.contactAreas == mesh.contactAreas);
+    // the memory is bounded by the mesh itself, not by the size of the file
+    CHECK(peak < 3 * meshBytes);
+    CHECK(peak < fileBytes / 4);
+}
+
+// ParticleTopology.cpp
+TEST_CASE("Check triangle extraction") {
+    // previous extraction, every new triangle was compared with all triangles found so far
+    const auto linearExtraction = [](const ParticleTopology &topology) {
+        std::vector<std::array<unsigned int, 3>> triangles;
+        const auto &offsets = topology.getNeighbourOffsets();
+        const auto &ids = topology.getNeighbourIds();
+        for (unsigned int p = 0; p < topology.getNumberOfParticles(); p++) {
+            for (auto i = offsets[p]; i < offsets[p + 1]; i++) {
+                for (auto j = i + 1; j < offsets[p + 1]; j++) {
+                    if (std::find(ids.begin() + offsets[ids[i]], ids.begin() + offsets[ids[i] + 1], ids[j]) ==
+                        ids.begin() + offsets[ids[i] + 1]) {
+                        continue;
+                    }
+                    std::array<unsigned int, 3> triangle{p, ids[i], ids[j]};
+                    std::sort(triangle.begin(), triangle.end());
+                    if (std::find(triangles.begin(), triangles.end(), triangle) == triangles.end()) {
+                        triangles.push_back(triangle);
+                    }
+                }
+            }
+        }
+        return triangles;
+    };
+
+    const auto mesh = ParticleTopology::load("../../input/particle-dist/513particles-delauney.xml", 20.0);
+    CHECK(mesh->getTriangles() == linearExtraction(*mesh));
+
+    for (const auto &[rows, columns]: {std::make_pair(27u, 19u), std::make_pair(60u, 50u)}) {
+        const auto lattice = ParticleTopology::fromMesh(abm::test::latticeMesh(rows, columns), 20.0);
+        CHECK(lattice->getTriangles().size() == 2 * (rows - 1) * (columns - 1));
+        CHECK(lattice->getTriangles() == linearExtraction(*lattice));
+    }
+}
+
+// ParticleTopology.cpp
+TEST_CASE("Check particle ordering") {
+    const auto mesh = abm::test::shuffledMesh(abm::test::latticeMesh(100, 100));
+    const auto input = ParticleTopology::fromMesh(mesh, 20.0);
+    std::vector<double> inputChanges;
+    double inputIdDistance = 0;
+    for (const auto &[name, ordering]: {std::make_pair("none", ParticleOrdering::NONE),
+                                        std::make_pair("morton", ParticleOrdering::MORTON),
+                                        std::make_pair("hilbert", ParticleOrdering::HILBERT),
+                                        std::make_pair("rcm", ParticleOrdering::RCM)}) {
+        const auto topology = ParticleTopology::fromMesh(mesh, 20.0, ordering);
+        const auto numberOfParticles = static_cast<unsigned int>(topology->getNumberOfParticles());
+        REQUIRE(numberOfParticles == input->getNumberOfParticles());
+
+        // every particle keeps its input id, position and neighbours (in the same order)
+        const auto &inputIds = topology->getInputIds();
+        bool consistent = true;
+        double idDistance = 0;
+        for (unsigned int id = 0; id < numberOfParticles; id++) {
+            const auto inputId = inputIds[id];
+            consistent &= topology->getIdsOfInputIds()[inputId] == id;
+            consistent &= topology->getPositions()[id].x == input->getPositions()[inputId].x &&
+                          topology->getPositions()[id].y == input->getPositions()[inputId].y;
+            const auto row = topology->getNeighbourOffsets()[id], inputRow = input->getNeighbourOffsets()[inputId];
+            consistent &= topology->getNeighbourOffsets()[id + 1] - row == input->getNeighbourOffsets()[inputId + 1] - inputRow;
+            for (auto k = row; consistent && k < topology->getNeighbourOffsets()[id + 1]; k++) {
+                const auto neighbour = topology->getNeighbourIds()[k];
+                consistent &= inputIds[neighbour] == input->getNeighbourIds()[inputRow + k - row];
+                consistent &= topology->getPreFactorsPSE()[k] == input->getPreFactorsPSE()[inputRow + k - row];
+                idDistance += std::abs(static_cast<double>(neighbour) - id);
+            }
+        }
+        CHECK(consistent);
+        // the orderings place the neighbours of the shuffled input close to each other
+        idDistance /= static_cast<double>(topology->getNeighbourIds().size());
+        if (ordering == ParticleOrdering::NONE) {
+            inputIdDistance = idDistance;
+        } else {
+            CHECK(idDistance < 0.1 * inputIdDistance);
+        }
+
+        // the PSE product of a reordered mesh is the product of the input, only the memory accesses change
+        ParticleStore particles;
+        particles.topology = topology;
+        particles.inSite.assign(numberOfParticles, 1);
+        for (unsigned int id = 0; id < numberOfParticles; id++) {
+            particles.concentrations.push_back(topology->getPositions()[id].x * topology->getPositions()[id].y);
+        }
+        DiffusionMatrix matrix;
+        matrix.compile(particles);
+        std::vector<double> changes(numberOfParticles, 0);
+        matrix.multiply(particles.concentrations, changes, 0.001);
+        if (ordering == ParticleOrdering::NONE) {
+            inputChanges = changes;
+        }
+        bool sameChanges = true;
+        for (unsigned int id = 0; id < numberOfParticles; id++) {
+            sameChanges &= changes[id] == inputChanges[inputIds[id]];
+        }
+        CHECK(sameChanges);
+    }
+}
+
+// ParticleMeshGenerator.cpp
+TEST_CASE("Check spherical particle mesh generation") {
+    const auto input = ParticleTopology::load("../../input/particle-dist/513particles-delauney.xml", 20.0);
+    const double radius = 26.2;
+    for (const auto numberOfParticles: {513u, 10000u}) {
+        const auto mesh = ParticleMeshGenerator::sphere(numberOfParticles, radius, {1, 2, 3});
+        REQUIRE(mesh.areas.size() == numberOfParticles);
+
+        // symmetric neighbourhood without duplicates, particles on the sphere and Voronoi areas that cover it
+        bool symmetric = true, onSphere = true;
+        unsigned int minDegree = numberOfParticles, maxDegree = 0;
+        for (unsigned int i = 0; i < numberOfParticles; i++) {
+            const auto first = mesh.neighbourIds.begin() + mesh.neighbourOffsets[i];
+            const auto last = mesh.neighbourIds.begin() + mesh.neighbourOffsets[i + 1];
+            minDegree = std::min(minDegree, static_cast<unsigned int>(last - first));
+            maxDegree = std::max(maxDegree, static_cast<unsigned int>(last - first));
+            std::vector<std::uint32_t> sorted(first, last);
+            std::sort(sorted.begin(), sorted.end());
+            symmetric &= std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end() &&
+                         std::find(first, last, i) == last;
+            for (auto it = first; it != last; ++it) {
+                const auto other = mesh.neighbourIds.begin() + mesh.neighbourOffsets[*it];
+                const auto otherLast = mesh.neighbourIds.begin() + mesh.neighbourOffsets[*it + 1];
+                symmetric &= std::find(other, otherLast, i) != otherLast;
+            }
+            const Coordinate3D position{mesh.positions[3 * i] - 1, mesh.positions[3 * i + 1] - 2, mesh.positions[3 * i + 2] - 3};
+            onSphere &= std::abs(position.getMagnitude() - radius) < 1e-9 * radius;
+        }
+        CHECK(symmetric);
+        CHECK(onSphere);
+        CHECK(minDegree >= 4);
+        CHECK(maxDegree <= 8);
+        const double sumAreas = std::accumulate(mesh.areas.begin(), mesh.areas.end(), 0.0);
+        CHECK(std::abs(sumAreas - 4 * M_PI * radius * radius) < 1e-6 * sumAreas);
+        const auto minmax = std::minmax_element(mesh.areas.begin(), mesh.areas.end());
+        CHECK(*minmax.second < 1.5 * *minmax.first);
+
+        // a triangulation of the sphere (Euler characteristic 2) has 2 n - 4 triangles and 3 n - 6 edges
+        const auto topology = ParticleTopology::fromMesh(mesh, 20.0);
+        CHECK(mesh.neighbourIds.size() == 2 * (3 * static_cast<size_t>(numberOfParticles) - 6));
+        CHECK(topology->getTriangles().size() == 2 * static_cast<size_t>(numberOfParticles) - 4);
+        if (numberOfParticles == input->getNumberOfParticles()) {
+            // same resolution as the particle-delauney input, so the prefactors are of the same magnitude
+            const auto meanPreFactor = [](const ParticleTopology &t) {
+                return std::accumulate(t.getPreFactorsPSE().begin(), t.getPreFactorsPSE().end(), 0.0) /
+                       static_cast<double>(t.getPreFactorsPSE().size());
+            };
+            CHECK(std::abs(meanPreFactor(*topology) / meanPreFactor(*input) - 1) < 0.05);
+        }
+    }
+}
+
+// Algorithms.cpp
+TEST_CASE("Check quadratic interpolation on triangles") {
+    // a smooth field of the space around the sphere and its gradient
+    const double radius = 26.2;
+    const auto field = [&](const Coordinate3D &p) {
+        return std::sin(2 * p.x / radius) * std::cos(p.y / radius) + p.z * p.z / (radius * radius);
+    };
+    const auto gradient = [&](const Coordinate3D &p) {
+        return Coordinate3D{2 / radius * std::cos(2 * p.x / radius) * std::cos(p.y / radius),
+                            -1 / radius * std::sin(2 * p.x / radius) * std::sin(p.y / radius),
+                            2 * p.z / (radius * radius)};
+    };
+
+    // quadratic fields are reproduced, the vertex values are interpolated
+    const Coordinate3D c1{0, 0, 1}, c2{3, 0.5, 1}, c3{1, 2.5, 1.2};
+    const auto quadratic = [](const Coordinate3D &p) { return 1 + 2 * p.x - p.y + 0.5 * p.x * p.x + p.x * p.y - p.y * p.y; };
+    const auto quadraticGradient = [](const Coordinate3D &p) { return Coordinate3D{2 + p.x + p.y, -1 + p.x - 2 * p.y, 0}; };
+    const Coordinate3D inside = c1 * 0.2 + c2 * 0.5 + c3 * 0.3;
+    CHECK(Algorithms::interpolateBiquadraticOnTriangle(inside, c1, quadratic(c1), quadraticGradient(c1), c2, quadratic(c2),
+                                                       quadraticGradient(c2), c3, quadratic(c3), quadraticGradient(c3)) ==
+          doctest::Approx(quadratic(inside)).epsilon(1e-12));
+    CHECK(Algorithms::interpolateBiquadraticOnTriangle(c2, c1, 1.0, gradient(c1), c2, 2.0, gradient(c2), c3, 3.0, gradient(c3)) ==
+          doctest::Approx(2.0).epsilon(1e-12));
+
+    // the error of the linear interpolation decreases with the squared particle spacing, the quadratic one faster
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    std::vector<double> linearErrors, quadraticErrors;
+    for (const auto numberOfParticles: {500u, 2000u, 8000u}) {
+        const auto topology = ParticleTopology::fromMesh(ParticleMeshGenerator::sphere(numberOfParticles, radius, {}), 20.0);
+        const auto &positions = topology->getPositions();
+        double linearError = 0, quadraticError = 0;
+        for (const auto &triangle: topology->getTriangles()) {
+            const auto &p1 = positions[triangle[0]], &p2 = positions[triangle[1]], &p3 = positions[triangle[2]];
+            double l1 = uniform(generator), l2 = uniform(generator);
+            if (l1 + l2 > 1) {
+                l1 = 1 - l1;
+                l2 = 1 - l2;
+            }
+            const Coordinate3D point = p1 * (1 - l1 - l2) + p2 * l1 + p3 * l2;
+            const auto l = Algorithms::barycentricCoordinates(point, p1, p2, p3);
+            const double linear = l[0] * field(p1) + l[1] * field(p2) + l[2] * field(p3);
+            const double quadratic = Algorithms::interpolateBiquadraticOnTriangle(point, p1, field(p1), gradient(p1),
+                                                                                 p2, field(p2), gradient(p2),
+                                                                                 p3, field(p3), gradient(p3));
+            linearError = std::max(linearError, std::abs(linear - field(point)));
+            quadraticError = std::max(quadraticError, std::abs(quadratic - field(point)));
+        }
+        linearErrors.push_back(linearError);
+        quadraticErrors.push_back(quadraticError);
+        MESSAGE(numberOfParticles << " particles: maximal error linear " << linearError << ", quadratic " << quadraticError);
+        CHECK(quadraticError < linearError);
+    }
+    // four times the particles halve the spacing, the errors drop by four (second order) and eight (third order)
+    CHECK(linearErrors[1] / linearErrors[2] > 3);
+    CHECK(quadraticErrors[1] / quadraticErrors[2] > 6);
+    // the quadratic interpolation on the coarsest mesh is more accurate than the linear one on the finest
+    CHECK(quadraticErrors[0] < linearErrors[2]);
+}
+
+// StaticBalloonList.cpp
+TEST_CASE("Check flat static balloon list") {
+    // mouse alveolus, the grid and threshold of the particle manager
+    const double radius = 50;
+    const Coordinate3D lower{-radius - 5, -radius - 5, -radius - 5}, upper{radius + 5, radius + 5, radius + 5};
+    const double gridConstant = 10.61, threshold = 10.6;
+    const auto mesh = ParticleMeshGenerator::sphere(5000, radius, {0, 0, 0});
+    const auto numberOfParticles = static_cast<unsigned int>(mesh.areas.size());
+    StaticBalloonList balloonList(gridConstant, lower, upper);
+    balloonList.setThreshold(threshold);
+
+    // the former layout: a vector per grid point and the coordinates in a map
+    const auto gridIndex = [&](double value, double lowerValue) {
+        return static_cast<int>(std::round((value - lowerValue) / gridConstant));
+    };
+    const int nx = static_cast<int>(std::ceil((upper.x - lower.x) / gridConstant)) + 1;
+    const int ny = static_cast<int>(std::ceil((upper.y - lower.y) / gridConstant)) + 1;
+    const int nz = static_cast<int>(std::ceil((upper.z - lower.z) / gridConstant)) + 1;
+    std::vector<std::vector<std::vector<std::vector<unsigned int>>>> grid(
+            nx, std::vector<std::vector<std::vector<unsigned int>>>(ny, std::vector<std::vector<unsigned int>>(nz)));
+    std::map<unsigned int, Coordinate3D> coordinates;
+    for (unsigned int id = 0; id < numberOfParticles; id++) {
+        const Coordinate3D position{mesh.positions[3 * id], mesh.positions[3 * id + 1], mesh.positions[3 * id + 2]};
+        balloonList.addCoordinateWithId(position, id);
+        grid[gridIndex(position.x, lower.x)][gridIndex(position.y, lower.y)][gridIndex(position.z, lower.z)].push_back(id);
+        coordinates[id] = position;
+    }
+    CHECK(balloonList.getNumberOfObjects() == numberOfParticles);
+    const auto formerInteractions = [&](Coordinate3D position, std::vector<unsigned int> &neighbours) {
+        const int u = gridIndex(position.x, lower.x), v = gridIndex(position.y, lower.y), w = gridIndex(position.z, lower.z);
+        const int reach = static_cast<int>(std::ceil(threshold / gridConstant));
+        for (int i = std::max(0, u - reach); i <= std::min(nx - 1, u + reach); i++) {
+            for (int j = std::max(0, v - reach); j <= std::min(ny - 1, v + reach); j++) {
+                for (int k = std::max(0, w - reach); k <= std::min(nz - 1, w + reach); k++) {
+                    for (const auto id: grid[i][j][k]) {
+                        if (position.calculateEuclidianDistance(coordinates[id]) < threshold) {
+                            neighbours.push_back(id);
+                        }
+                    }
+                }
+            }
+        }
+    };
+
+    // positions of agents on the surface, the queries list the same particles in the same order
+    std::mt19937 generator(7);
+    std::normal_distribution<double> normal;
+    std::vector<Coordinate3D> queries;
+    for (int q = 0; q < 500; q++) {
+        Coordinate3D direction{normal(generator), normal(generator), normal(generator)};
+        direction.setMagnitude(radius);
+        queries.push_back(direction);
+    }
+    std::vector<unsigned int> flat, former, closest;
+    flat.reserve(numberOfParticles);
+    former.reserve(numberOfParticles);
+    closest.reserve(3);
+    bool identical = true;
+    for (const auto &position: queries) {
+        flat.clear();
+        former.clear();
+        balloonList.getInteractions(position, flat);
+        formerInteractions(position, former);
+        identical &= flat == former && !flat.empty();
+        closest.clear();
+        balloonList.getClosestObjectIndices(position, closest, 3);
+        identical &= closest.size() == 3 && closest[0] == balloonList.getClosestObjectIndex(position);
+    }
+    CHECK(identical);
+
+    // the flat cell list answers the queries without allocating
+    const auto allocationsBefore = numberOfAllocations.load();
+    for (const auto &position: queries) {
+        flat.clear();
+        balloonList.getInteractions(position, flat);
+        closest.clear();
+        balloonList.getClosestObjectIndices(position, closest, 3);
+    }
+    CHECK(numberOfAllocations.load() == allocationsBefore);
+}